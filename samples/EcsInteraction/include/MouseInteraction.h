@@ -95,14 +95,25 @@ struct Button  : public ecs::Component {
 
 
 
+// last mouse event seen by the MouseInputSystem, shared with other systems as a manager resource
+struct MouseState {
+    ci::vec2 pos;
+    bool isDown = false;
+};
+
+
 struct MouseInputSystem : public ecs::System {
  
     std::vector< ecs::EntityRef > mActiveEntities;
     
-    
+    MouseInputSystem(){
+        writesResource<MouseState>();
+    }
 
     void setup() override {
         
+        getManager()->setResource<MouseState>();
+        
         ci::app::App::get()->getWindow()->getSignalMouseDown().connect( std::bind( &MouseInputSystem::mouseDown, this, std::placeholders::_1 ) );
         ci::app::App::get()->getWindow()->getSignalMouseDrag().connect( std::bind( &MouseInputSystem::mouseDrag, this, std::placeholders::_1 ) );
         ci::app::App::get()->getWindow()->getSignalMouseUp().connect( std::bind( &MouseInputSystem::mouseUp, this, std::placeholders::_1 ) );
@@ -111,19 +122,32 @@ struct MouseInputSystem : public ecs::System {
     }
     
     
+    // buttons inside disabled or hidden subtrees can't be hit
+    static bool isPickable( const Transform* transform ){
+        return transform->isEnabledInHierarchy() && transform->isVisibleInHierarchy();
+    }
+    
     void mouseDown( const ci::app::MouseEvent& iEvent  ){
         
-        auto entities = getManager()->getEntitiesWithComponents<Button>();
-        
-        std::reverse(entities.begin(), entities.end());
+        auto mouse = getManager()->getResource<MouseState>();
+        mouse->pos = iEvent.getPos();
+        mouse->isDown = true;
         
+        auto entities = getManager()->getEntitiesWithComponentsSpan<Button>();
         
-        for(  auto& e : entities){
+        // last created buttons are on top, visit them first
+        for( size_t i = entities.size(); i-- > 0; ){
+            
+            auto e = entities[i];
 
             
             auto b = e->getComponent<Bounds>();
             auto button =  e->getComponent<Button>();
             auto transform = e->getComponent<Transform>();
+            
+            if( !isPickable( transform ) ){
+                continue;
+            }
  
             ci::vec2 transformedPoint;
             ci::mat4 inverdedMatrix  = glm::inverse(transform->getWorldTransform());
@@ -148,18 +172,24 @@ struct MouseInputSystem : public ecs::System {
     
     void mouseMove( const ci::app::MouseEvent& iEvent  ){
         
-        auto entities = getManager()->getEntitiesWithComponents<Button>();
+        getManager()->getResource<MouseState>()->pos = iEvent.getPos();
         
-        std::reverse(entities.begin(), entities.end());
+        auto entities = getManager()->getEntitiesWithComponentsSpan<Button>();
         
-        
-        for(  auto& e : entities){
+        // last created buttons are on top, visit them first
+        for( size_t i = entities.size(); i-- > 0; ){
+            
+            auto e = entities[i];
             
             
             auto b = e->getComponent<Bounds>();
             auto button =  e->getComponent<Button>();
             auto transform = e->getComponent<Transform>();
             
+            if( !isPickable( transform ) ){
+                continue;
+            }
+            
             ci::vec2 transformedPoint;
             ci::mat4 inverdedMatrix  = glm::inverse(transform->getWorldTransform());
             auto p = inverdedMatrix * glm::vec4( iEvent.getX(), iEvent.getY(), 0.0f, 1.0f);
@@ -183,17 +213,19 @@ struct MouseInputSystem : public ecs::System {
     
     void mouseDrag( const ci::app::MouseEvent& iEvent  ){
         
+        getManager()->getResource<MouseState>()->pos = iEvent.getPos();
+        
         
         
     }
     
     void mouseUp( const ci::app::MouseEvent& iEvent  ){
+        
+        auto mouse = getManager()->getResource<MouseState>();
+        mouse->pos = iEvent.getPos();
+        mouse->isDown = false;
 
-        for(  auto& e : getManager()->getEntitiesWithComponents<Button>()){
-            
-            if( e->isActive() == false ){
-                continue;
-            }
+        for(  auto e : getManager()->getActiveEntitiesWithComponentsSpan<Button>()){
             
             auto b = e->getComponent<Bounds>();
             auto button =  e->getComponent<Button>();
@@ -214,13 +246,17 @@ struct MouseInputSystem : public ecs::System {
     
     void draw() override {
         
-        for(  auto& e : getManager()->getEntitiesWithComponents<Button>()){
+        for(  auto e : getManager()->getEntitiesWithComponentsSpan<Button>()){
             
                 ci::Color color(1.0f, 0.0f, 0.0f);
             
             auto button = e->getComponent<Button>();
             auto transform = e->getComponent<Transform>();
             auto bounds = e->getComponent<Bounds>();
+            
+            if( !transform->isVisibleInHierarchy() ){
+                continue;
+            }
 
             
                 if( button->currentState == Button::State::MOUSE_DOWN  ){
@@ -46,6 +46,10 @@ class SceneButton : public ecs::Entity, public ecs::IDrawable {
 
     void draw()  override {
         
+        if( !getComponent<Transform>()->isVisibleInHierarchy() ){
+            return;
+        }
+        
         Color c(1.0f, 0.8f, 0.8f );
         
         if( getComponent<Button>()->currentState == Button::State::MOUSE_DOWN ){
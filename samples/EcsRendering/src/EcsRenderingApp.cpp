@@ -10,8 +10,8 @@
 
 #include "DrawTargets.h"
 
-// add a particle system in the Fbo target, it needs to be set as not "drawable" other wise the system will be drawn twice, in the fbo and the default draw call in the manager
-#include "Particles.h"
+// add a particle system in the Fbo target, it sets itself as not "drawable" other wise the system would be drawn twice, in the fbo and the default draw call in the manager
+#include "Utils/ParticleEmitter.h"
 
 using namespace ci;
 using namespace ci::app;
@@ -48,7 +48,7 @@ struct RectComponent : public ecs::Component, public ecs::IDrawable{
         gl::ScopedModelMatrix m;
         
         auto c = entity->getComponent<Transform>();
-        gl::multModelMatrix(c->getWorldTransform());
+        gl::multModelMatrix(c->getInterpolatedWorldTransform());
         
         auto color = Color::white();
         
@@ -148,7 +148,9 @@ class EcsRenderingApp : public App {
     std::shared_ptr<MyCustomEntity> mCustom;
 
     // systems -----
-    std::shared_ptr<ParticleSystem> mParticleSystem;
+    std::shared_ptr<ParticleEmitterSystem> mParticleSystem;
+    ecs::EntityRef mEmitter;
+    ecs::RandomStream mRandom{ 1 }; // emission directions and lifetimes, the same on every run
     
     // draw targets ---
     std::shared_ptr<FboDrawTarget> mFboDrawTarget;
@@ -173,9 +175,13 @@ void EcsRenderingApp::setup()
     { // FBO target ------
 
         // add a particle system to the draw target
-        mParticleSystem = mManager.createSystem<ParticleSystem>();
+        mParticleSystem = mManager.createSystem<ParticleEmitterSystem>();
         mParticleSystem->setDrawTarget( mBlurDrawTarget );
         
+        // all the particles live in one emitter component instead of an entity each
+        mEmitter = mManager.createEntity();
+        mEmitter->addComponent<ParticleEmitter>( 2048 );
+        
         // create a rotating rect for fun
         mEntity = mManager.createEntity();
         mEntity->addComponent<Transform>()->setPos(vec3(200,200,0));
@@ -205,6 +211,8 @@ void EcsRenderingApp::setup()
     
     console() << "initialized!" << "💊" << std::endl;
     
+    // simulate at 60hz regardless of the frame rate, the drawables interpolate between steps
+    mManager.setFixedTimestep( 1.0 / 60.0 );
     
     mManager.setup();
 }
@@ -225,12 +233,23 @@ void EcsRenderingApp::update()
     
     if( getElapsedFrames() % 10 == 0 ){
         
-        mParticleSystem->addParticle( { 200,200 } );
+        auto emitter = mEmitter->getComponent<ParticleEmitter>();
+        for( int i = 0; i < 10; ++i ){
+            float angle = mRandom.nextFloat( 0.f, 2.f * float( M_PI ) );
+            emitter->emit( { 200,200 }, vec2( cos( angle ), sin( angle ) ) * 7.f, mRandom.nextFloat( 5, 20 ) );
+        }
     }
     
     ui::DragFloat( "blur amt",  &mBlurDrawTarget->blurAmt, 0.01f );
     ui::DragFloat( "att",  &mBlurDrawTarget->attenuation, 0.01f );
     
+    // hiding the transform takes the rect out of its draw target
+    auto rectTransform = mEntity->getComponent<Transform>();
+    bool rectVisible = rectTransform->isVisible();
+    if( ui::Checkbox( "rect visible", &rectVisible ) ){
+        rectTransform->setVisible( rectVisible );
+    }
+    
     mManager.update();
     
 }
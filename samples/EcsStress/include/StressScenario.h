@@ -0,0 +1,437 @@
+//
+//  StressScenario.h
+//  EcsStress
+//
+//  Scripted load shared by the EcsStress app and the headless runner: a large
+//  particle field, deep transform trees and a dense grid of hit tested
+//  buttons, plus a fixed script of churn, reparenting and activation changes.
+//  Everything is seeded and advanced by a constant step, so two runs with the
+//  same config do exactly the same work.
+//
+//  Build with ECS_ENABLE_PROFILING=1 to get per system timings.
+//
+
+#ifndef StressScenario_h
+#define StressScenario_h
+
+#include "ecs/Manager.h"
+#include "Utils/Transform.h"
+#include "Utils/TransformSystem.h"
+
+#include "cinder/Rect.h"
+
+#include <map>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstdio>
+#include <cmath>
+#include <algorithm>
+
+#if defined( __APPLE__ )
+    #include <mach/mach.h>
+#elif defined( _WIN32 )
+    #include <windows.h>
+    #include <psapi.h>
+#else
+    #include <unistd.h>
+#endif
+
+
+struct StressConfig {
+
+    std::size_t numParticles = 200000;
+
+    // every root carries a chain `treeDepth` deep, every chain node has `treeLeaves` leaves
+    std::size_t numTreeRoots = 64;
+    std::size_t treeDepth = 32;
+    std::size_t treeLeaves = 4;
+
+    std::size_t gridColumns = 200;
+    std::size_t gridRows = 200;
+
+    std::uint32_t seed = 1;
+
+    ci::Rectf bounds{ 0, 0, 1280, 720 };
+};
+
+
+// Components ------
+
+struct StressParticle : ecs::Component {
+    ci::vec2 pos;
+    ci::vec2 prevPos;
+    ci::vec2 vel;
+    float lifetime = 0;
+};
+
+struct StressSpin : ecs::Component {
+    float speed = 0;
+    float angle = 0;
+};
+
+struct StressButton : ecs::Component {
+    ci::Rectf bounds;
+    bool hovered = false;
+    std::uint32_t clicks = 0;
+};
+
+
+// Systems ------
+
+// every system advances by the same constant step, whatever the frame rate, so the runs are reproducible
+static const float kStressStep = 1.0f / 60.0f;
+
+struct StressParticleSystem : ecs::System {
+
+    StressParticleSystem( ci::Rectf bounds, std::uint32_t seed ) : mBounds( bounds ) { setRandomSeed( seed ); }
+
+    void setup() override { drawable = false; }
+
+    // split in fixed chunks across the workers, expired particles are recycled in place with the chunk's own random
+    // stream, so the result doesn't depend on the number of threads
+    void update() override {
+
+        auto particles = getManager()->getComponentsSpan<StressParticle>();
+        auto numChunks = ( particles.size() + mChunkSize - 1 ) / mChunkSize;
+
+        getManager()->getWorkerPool().parallelFor( numChunks, [this, &particles]( std::size_t chunk, std::size_t ){
+
+            auto random = getRandomStream( chunk );
+            auto end = std::min( ( chunk + 1 ) * mChunkSize, particles.size() );
+
+            for( auto i = chunk * mChunkSize; i < end; ++i ){
+
+                auto p = particles[i];
+                p->prevPos = p->pos;
+                p->pos += p->vel * kStressStep;
+                p->lifetime -= kStressStep;
+
+                if( p->pos.x < mBounds.x1 || p->pos.x > mBounds.x2 ) p->vel.x = -p->vel.x;
+                if( p->pos.y < mBounds.y1 || p->pos.y > mBounds.y2 ) p->vel.y = -p->vel.y;
+
+                if( p->lifetime < 0 ){
+                    respawn( p, random );
+                }
+            }
+        } );
+    }
+
+    void respawn( StressParticle* p, ecs::RandomStream& random ){
+
+        p->pos = p->prevPos = ci::vec2( random.nextFloat( mBounds.x1, mBounds.x2 ), random.nextFloat( mBounds.y1, mBounds.y2 ) );
+        p->vel = ci::vec2( random.nextFloat( -120.0f, 120.0f ), random.nextFloat( -120.0f, 120.0f ) );
+        p->lifetime = random.nextFloat( 2.0f, 12.0f );
+    }
+
+    // from the main thread, on keys counting down from the top so they never repeat a chunk's numbers, and
+    // numbered per call so two spawns between the same steps don't place their particles on top of each other.
+    // `batched` is for the initial population only: a batch stays allocated while any of its particles lives, and
+    // the churned ones die at different times
+    void spawn( std::size_t count, bool batched ){
+
+        auto random = getRandomStream( kSpawnKey - mNumSpawns++ );
+
+        if( batched ){
+            for( auto& e : getManager()->createEntities<StressParticle>( count ) ){
+                respawn( e->getComponent<StressParticle>(), random );
+            }
+            return;
+        }
+
+        for( std::size_t i = 0; i < count; ++i ){
+            respawn( getManager()->createEntity()->addComponent<StressParticle>(), random );
+        }
+    }
+
+    static const std::uint64_t kSpawnKey = ~0ull;
+
+    ci::Rectf mBounds;
+    std::size_t mChunkSize = 8192;
+    std::uint64_t mNumSpawns = 0;
+};
+
+struct StressSpinSystem : ecs::System {
+
+    void setup() override { drawable = false; }
+
+    void update() override {
+
+        for( auto e : getManager()->getEntitiesWithComponentsSpan<StressSpin, Transform>() ){
+
+            auto spin = e->getComponent<StressSpin>();
+            spin->angle += spin->speed * kStressStep;
+            e->getComponent<Transform>()->setRotation( spin->angle );
+        }
+    }
+};
+
+// moves a scripted cursor over the grid and hit tests every active button against it
+struct StressButtonSystem : ecs::System {
+
+    void setup() override { drawable = false; }
+
+    void update() override {
+
+        mTime += kStressStep;
+        mCursor = mBounds.getCenter() + ci::vec2( std::sin( mTime * 1.3f ), std::sin( mTime * 1.7f ) ) * mBounds.getSize() * 0.45f;
+        mClicking = std::fmod( mTime, 0.5f ) < kStressStep;
+
+        for( auto e : getManager()->getActiveEntitiesWithComponentsSpan<StressButton, Transform>() ){
+
+            auto button = e->getComponent<StressButton>();
+            auto local = glm::inverse( e->getComponent<Transform>()->getWorldTransform() ) * ci::vec4( mCursor, 0, 1 );
+
+            button->hovered = button->bounds.contains( ci::vec2( local ) );
+            if( button->hovered && mClicking ){
+                button->clicks++;
+            }
+        }
+    }
+
+    ci::Rectf mBounds;
+    ci::vec2 mCursor;
+    float mTime = 0;
+    bool mClicking = false;
+};
+
+
+// Stats ------
+
+struct StressTiming {
+    double lastMicros = 0;
+    double totalMicros = 0;
+    double maxMicros = 0;
+    std::size_t samples = 0;
+
+    double getAverageMicros() const { return samples ? totalMicros / samples : 0.0; }
+};
+
+// resident memory of the process, 0 where it can't be read
+inline std::size_t getResidentBytes(){
+
+#if defined( __APPLE__ )
+    mach_task_basic_info info;
+    mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+    if( task_info( mach_task_self(), MACH_TASK_BASIC_INFO, (task_info_t)&info, &count ) == KERN_SUCCESS ){
+        return info.resident_size;
+    }
+    return 0;
+#elif defined( _WIN32 )
+    PROCESS_MEMORY_COUNTERS counters;
+    if( GetProcessMemoryInfo( GetCurrentProcess(), &counters, sizeof( counters ) ) ){
+        return counters.WorkingSetSize;
+    }
+    return 0;
+#else
+    long pages = 0, resident = 0;
+    if( auto file = std::fopen( "/proc/self/statm", "r" ) ){
+        if( std::fscanf( file, "%ld %ld", &pages, &resident ) != 2 ){
+            resident = 0;
+        }
+        std::fclose( file );
+    }
+    long pageSize = sysconf( _SC_PAGESIZE );
+    return pageSize > 0 ? static_cast<std::size_t>( resident ) * static_cast<std::size_t>( pageSize ) : 0;
+#endif
+}
+
+
+// Scenario ------
+
+class StressScenario {
+
+public:
+
+    explicit StressScenario( const StressConfig& config = StressConfig() ) : mConfig( config ), mRandom( config.seed ) {
+
+        mManager = ecs::Manager::create();
+
+        mParticles = mManager->createSystem<StressParticleSystem>( config.bounds, config.seed );
+        mParticles->setName( "Particles" );
+
+        mSpin = mManager->createSystem<StressSpinSystem>();
+        mSpin->setName( "Spin" );
+
+        mButtons = mManager->createSystem<StressButtonSystem>();
+        mButtons->setName( "Buttons" );
+        mButtons->mBounds = config.bounds;
+
+        mTransforms = mManager->createSystem<TransformSystem>();
+        mTransforms->setName( "Transforms" );
+        mTransforms->drawable = false;
+
+        mParticles->spawn( config.numParticles, true );
+        buildTrees();
+        buildGrid();
+
+        mManager->setup();
+    }
+
+    // runs one frame of the script then updates the manager
+    void step(){
+
+        runScript();
+        mManager->update();
+        mFrame++;
+
+        collectTimings();
+    }
+
+    ecs::ManagerRef getManager() const { return mManager; }
+    const StressConfig& getConfig() const { return mConfig; }
+    std::uint64_t getFrame() const { return mFrame; }
+
+    // what the script did last, for display
+    const std::string& getLastEvent() const { return mLastEvent; }
+
+    // per system and phase ( "Particles/update", "refresh", ... ), empty without ECS_ENABLE_PROFILING
+    const std::map<std::string, StressTiming>& getTimings() const { return mTimings; }
+    const StressTiming& getFrameTiming() const { return mFrameTiming; }
+
+    std::shared_ptr<StressButtonSystem> getButtonSystem() const { return mButtons; }
+    std::shared_ptr<TransformSystem> getTransformSystem() const { return mTransforms; }
+
+protected:
+
+    void buildTrees(){
+
+        TransformReparentBatch batch( mManager.get() );
+        batch.reserve( mConfig.numTreeRoots * mConfig.treeDepth * ( mConfig.treeLeaves + 1 ) );
+
+        // the nodes are placed by their offset to the parent, so they don't keep their world transform
+        for( std::size_t r = 0; r < mConfig.numTreeRoots; ++r ){
+
+            auto root = mManager->createEntity();
+            auto rootTransform = root->addComponent<Transform>();
+            rootTransform->setPos( ci::vec3( mRandom.nextFloat( mConfig.bounds.x1, mConfig.bounds.x2 ), mRandom.nextFloat( mConfig.bounds.y1, mConfig.bounds.y2 ), 0 ) );
+            root->addComponent<StressSpin>()->speed = mRandom.nextFloat( -2.0f, 2.0f );
+            mTreeRoots.push_back( rootTransform );
+
+            auto parent = rootTransform;
+            for( std::size_t d = 0; d < mConfig.treeDepth; ++d ){
+
+                auto node = mManager->createEntity()->addComponent<Transform>();
+                node->setPos( ci::vec3( 12, 0, 0 ) );
+                node->setRotation( 0.15f );
+                node->setScale( 0.98f );
+                batch.setParent( node, parent, false );
+
+                for( auto& leaf : mManager->createEntities<Transform>( mConfig.treeLeaves ) ){
+                    auto t = leaf->getComponent<Transform>();
+                    t->setPos( ci::vec3( 0, 6, 0 ) );
+                    batch.setParent( t, node, false );
+                }
+
+                parent = node;
+            }
+        }
+
+        batch.apply();
+    }
+
+    void buildGrid(){
+
+        auto cell = ci::vec2( mConfig.bounds.getWidth() / mConfig.gridColumns, mConfig.bounds.getHeight() / mConfig.gridRows );
+
+        auto buttons = mManager->createEntities<Transform, StressButton>( mConfig.gridColumns * mConfig.gridRows );
+        mGridRows.resize( mConfig.gridRows );
+
+        for( std::size_t i = 0; i < buttons.size(); ++i ){
+
+            auto col = i % mConfig.gridColumns;
+            auto row = i / mConfig.gridColumns;
+
+            buttons[i]->getComponent<Transform>()->setPos( ci::vec3( mConfig.bounds.getUpperLeft() + cell * ci::vec2( col, row ), 0 ) );
+            buttons[i]->getComponent<StressButton>()->bounds = ci::Rectf( ci::vec2( 1 ), cell - ci::vec2( 1 ) );
+            mGridRows[row].push_back( buttons[i] );
+        }
+    }
+
+    // the same events on the same frames every run
+    void runScript(){
+
+        // structural churn: a tenth of the particles destroyed and created again
+        if( mFrame % 120 == 60 ){
+
+            std::size_t n = 0, every = 10;
+            auto destroyed = mManager->destroyWhere( [&n, every]( const ecs::EntityRef& e ){ return e->hasComponent<StressParticle>() && ( n++ % every ) == 0; } );
+            mParticles->spawn( destroyed, false );
+            mLastEvent = "churned " + std::to_string( destroyed ) + " particles";
+        }
+
+        // every tree's chain moves under the next root in one batch
+        if( mFrame % 300 == 150 && mTreeRoots.size() > 1 ){
+
+            TransformReparentBatch batch( mManager.get() );
+            for( std::size_t r = 0; r < mTreeRoots.size(); ++r ){
+                auto chain = mTreeRoots[r]->getFirstChild();
+                if( chain ){
+                    batch.setParent( chain, mTreeRoots[ ( r + 1 ) % mTreeRoots.size() ] );
+                }
+            }
+            batch.apply();
+            mLastEvent = "reparented " + std::to_string( mTreeRoots.size() ) + " chains";
+        }
+
+        // every other grid row goes inactive, then comes back
+        if( mFrame % 240 == 200 || mFrame % 240 == 20 ){
+
+            bool active = mFrame % 240 == 20;
+            for( std::size_t r = 1; r < mGridRows.size(); r += 2 ){
+                for( auto& e : mGridRows[r] ){
+                    e->setActive( active );
+                }
+            }
+            mLastEvent = active ? "grid rows enabled" : "grid rows disabled";
+        }
+    }
+
+    void collectTimings(){
+
+#if ECS_ENABLE_PROFILING
+        auto frame = mManager->getProfiler().getLastFrame();
+        if( frame == nullptr ){
+            return;
+        }
+
+        addTiming( mFrameTiming, frame->durationMicros );
+        addTiming( mTimings["refresh"], frame->refreshMicros );
+
+        // a system can record several events in a frame ( fixed steps ), they add up
+        std::map<std::string, double> frameTotals;
+        for( auto& e : frame->events ){
+            frameTotals[ e.name + "/" + e.category ] += e.durationMicros;
+        }
+        for( auto& t : frameTotals ){
+            addTiming( mTimings[t.first], t.second );
+        }
+#endif
+    }
+
+    static void addTiming( StressTiming& timing, double micros ){
+        timing.lastMicros = micros;
+        timing.totalMicros += micros;
+        timing.maxMicros = std::max( timing.maxMicros, micros );
+        timing.samples++;
+    }
+
+    StressConfig mConfig;
+    ecs::RandomStream mRandom;
+    std::uint64_t mFrame = 0;
+    std::string mLastEvent;
+
+    ecs::ManagerRef mManager;
+    std::shared_ptr<StressParticleSystem> mParticles;
+    std::shared_ptr<StressSpinSystem> mSpin;
+    std::shared_ptr<StressButtonSystem> mButtons;
+    std::shared_ptr<TransformSystem> mTransforms;
+
+    std::vector<Transform*> mTreeRoots;
+    std::vector< std::vector<ecs::EntityRef> > mGridRows;
+
+    std::map<std::string, StressTiming> mTimings;
+    StressTiming mFrameTiming;
+};
+
+#endif /* StressScenario_h */
@@ -0,0 +1,188 @@
+#include "cinder/app/App.h"
+#include "cinder/app/RendererGl.h"
+#include "cinder/gl/gl.h"
+
+#include "CinderImGui.h"
+
+#include "Utils/StatsPanel.h"
+
+#include "StressScenario.h"
+
+using namespace ci;
+using namespace ci::app;
+using namespace std;
+
+
+// Runs the stress scenario in a window: draws a subset of it and shows the timings, counts and memory.
+// The same scenario runs without a window in EcsStressHeadless.cpp
+
+class EcsStressApp : public App {
+  public:
+	void setup() override;
+	void update() override;
+	void draw() override;
+
+	void restart();
+	void drawStats();
+
+	StressConfig mConfig;
+	std::unique_ptr<StressScenario> mScenario;
+
+	bool mPaused = false;
+	bool mDrawParticles = true;
+	bool mDrawTrees = true;
+	bool mDrawGrid = true;
+	bool mShowMemory = false;
+};
+
+void EcsStressApp::setup()
+{
+	ui::initialize();
+
+	mConfig.bounds = Rectf( getWindowBounds() );
+	restart();
+}
+
+void EcsStressApp::restart()
+{
+	mScenario.reset();
+	mScenario.reset( new StressScenario( mConfig ) );
+}
+
+void EcsStressApp::update()
+{
+	if( !mPaused ){
+		mScenario->step();
+	}
+
+	drawStats();
+}
+
+void EcsStressApp::drawStats()
+{
+	auto manager = mScenario->getManager();
+	auto stats = manager->getStats();
+
+	ui::Begin( "Stress" );
+
+	ui::Text( "frame %llu  %.1f fps", (unsigned long long)mScenario->getFrame(), getAverageFps() );
+	ui::Text( "entities: %zu", stats.numEntities );
+	ui::Text( "ecs memory: %.1f MB  resident: %.1f MB", stats.getTotalBytes() / ( 1024.0 * 1024.0 ), getResidentBytes() / ( 1024.0 * 1024.0 ) );
+	ui::Text( "last event: %s", mScenario->getLastEvent().c_str() );
+	ui::Separator();
+
+	int particles = (int)mConfig.numParticles;
+	int roots = (int)mConfig.numTreeRoots;
+	int depth = (int)mConfig.treeDepth;
+	int columns = (int)mConfig.gridColumns;
+	int rows = (int)mConfig.gridRows;
+
+	ui::DragInt( "particles", &particles, 1000.0f, 0, 2000000 );
+	ui::DragInt( "tree roots", &roots, 1.0f, 0, 4096 );
+	ui::DragInt( "tree depth", &depth, 1.0f, 1, 512 );
+	ui::DragInt( "grid columns", &columns, 1.0f, 1, 1000 );
+	ui::DragInt( "grid rows", &rows, 1.0f, 1, 1000 );
+
+	mConfig.numParticles = particles;
+	mConfig.numTreeRoots = roots;
+	mConfig.treeDepth = depth;
+	mConfig.gridColumns = columns;
+	mConfig.gridRows = rows;
+
+	if( ui::Button( "restart" ) ){
+		restart();
+	}
+	ui::SameLine();
+	ui::Checkbox( "paused", &mPaused );
+
+	ui::Checkbox( "draw particles", &mDrawParticles );
+	ui::Checkbox( "draw trees", &mDrawTrees );
+	ui::Checkbox( "draw grid", &mDrawGrid );
+	ui::Checkbox( "memory by type", &mShowMemory );
+
+	ui::Separator();
+
+#if ECS_ENABLE_PROFILING
+	auto& frame = mScenario->getFrameTiming();
+	ui::Text( "update: %.2f ms ( avg %.2f, max %.2f )", frame.lastMicros / 1000.0, frame.getAverageMicros() / 1000.0, frame.maxMicros / 1000.0 );
+
+	ui::Columns( 4, "stress_timings" );
+	ui::Text( "system" );   ui::NextColumn();
+	ui::Text( "ms" );       ui::NextColumn();
+	ui::Text( "avg" );      ui::NextColumn();
+	ui::Text( "max" );      ui::NextColumn();
+	ui::Separator();
+
+	for( auto& t : mScenario->getTimings() ){
+		ui::Text( "%s", t.first.c_str() );                          ui::NextColumn();
+		ui::Text( "%.2f", t.second.lastMicros / 1000.0 );           ui::NextColumn();
+		ui::Text( "%.2f", t.second.getAverageMicros() / 1000.0 );   ui::NextColumn();
+		ui::Text( "%.2f", t.second.maxMicros / 1000.0 );            ui::NextColumn();
+	}
+	ui::Columns( 1 );
+
+	if( ui::Button( "export trace" ) ){
+		manager->getProfiler().exportChromeTrace( ( getAppPath() / "stress_trace.json" ).string() );
+	}
+#else
+	ui::TextWrapped( "build with ECS_ENABLE_PROFILING=1 for per system timings" );
+#endif
+
+	ui::End();
+
+	if( mShowMemory ){
+		ImGui::DrawManagerStats( *manager, &mShowMemory );
+	}
+}
+
+void EcsStressApp::draw()
+{
+	gl::clear( Color( 0, 0, 0 ) );
+	gl::ScopedBlendAlpha blend;
+
+	auto manager = mScenario->getManager();
+
+	if( mDrawGrid ){
+
+		gl::VertBatch grid( GL_TRIANGLES );
+		for( auto e : manager->getActiveEntitiesWithComponentsSpan<StressButton, Transform>() ){
+
+			auto button = e->getComponent<StressButton>();
+			auto pos = vec2( e->getComponent<Transform>()->getWorldPos() );
+			auto r = button->bounds + pos;
+
+			grid.color( button->hovered ? ColorA( 1, 0.5f, 0, 0.8f ) : ColorA( 1, 1, 1, 0.06f + std::min( button->clicks, 10u ) * 0.05f ) );
+			grid.vertex( r.getUpperLeft() );  grid.vertex( r.getUpperRight() ); grid.vertex( r.getLowerRight() );
+			grid.vertex( r.getUpperLeft() );  grid.vertex( r.getLowerRight() ); grid.vertex( r.getLowerLeft() );
+		}
+		grid.draw();
+	}
+
+	if( mDrawTrees ){
+
+		gl::VertBatch lines( GL_LINES );
+		lines.color( ColorA( 0.3f, 0.8f, 1.0f, 0.5f ) );
+		for( auto t : manager->getActiveComponentsSpan<Transform>() ){
+
+			if( t->hasParent() ){
+				lines.vertex( vec2( t->getParent()->getWorldPos() ) );
+				lines.vertex( vec2( t->getWorldPos() ) );
+			}
+		}
+		lines.draw();
+	}
+
+	if( mDrawParticles ){
+
+		gl::VertBatch points( GL_POINTS );
+		points.color( ColorA( 1, 1, 1, 0.4f ) );
+		for( auto p : manager->getComponentsSpan<StressParticle>() ){
+			points.vertex( p->pos );
+		}
+		points.draw();
+	}
+
+	manager->draw();
+}
+
+CINDER_APP( EcsStressApp, RendererGl, []( App::Settings* settings ){ settings->setWindowSize( 1280, 720 ); } )
@@ -0,0 +1,100 @@
+//
+//  EcsStressHeadless.cpp
+//  EcsStress
+//
+//  Runs the stress scenario without a window for a fixed number of frames and
+//  prints the per system timings, counts and memory. It is not part of the
+//  app projects, build it on its own against cinder, for example:
+//
+//  c++ -std=c++11 -O3 -DECS_ENABLE_PROFILING=1 -I../include -I../../../src -I$CINDER_PATH/include
+//      -I../../../../Cinder-ImGui/include -I../../../../Cinder-ImGui/lib/imgui
+//      EcsStressHeadless.cpp ../../../src/ecs/*.cpp ../../../src/Utils/*.cpp
+//      ../../../../Cinder-ImGui/src/CinderImGui.cpp ../../../../Cinder-ImGui/lib/imgui/*.cpp
+//      $CINDER_PATH/lib/macosx/Release/libcinder.a -o EcsStressHeadless
+//
+//  usage: EcsStressHeadless [--frames 600] [--particles 1000000] [--roots 64] [--depth 32]
+//                           [--leaves 4] [--columns 200] [--rows 200] [--seed 1] [--trace out.json]
+//
+
+#include "StressScenario.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <iomanip>
+
+using namespace std;
+
+int main( int argc, char* argv[] )
+{
+	StressConfig config;
+	size_t frames = 600;
+	string tracePath;
+
+	for( int i = 1; i < argc; i += 2 ){
+
+		if( i + 1 == argc ){
+			cerr << "missing value for " << argv[i] << endl;
+			return 1;
+		}
+
+		auto value = strtoull( argv[i + 1], nullptr, 10 );
+
+		if( !strcmp( argv[i], "--frames" ) )          frames = value;
+		else if( !strcmp( argv[i], "--particles" ) )  config.numParticles = value;
+		else if( !strcmp( argv[i], "--roots" ) )      config.numTreeRoots = value;
+		else if( !strcmp( argv[i], "--depth" ) )      config.treeDepth = value;
+		else if( !strcmp( argv[i], "--leaves" ) )     config.treeLeaves = value;
+		else if( !strcmp( argv[i], "--columns" ) )    config.gridColumns = value;
+		else if( !strcmp( argv[i], "--rows" ) )       config.gridRows = value;
+		else if( !strcmp( argv[i], "--seed" ) )       config.seed = (uint32_t)value;
+		else if( !strcmp( argv[i], "--trace" ) )      tracePath = argv[i + 1];
+		else{
+			cerr << "unknown option " << argv[i] << endl;
+			return 1;
+		}
+	}
+
+#if !ECS_ENABLE_PROFILING
+	if( !tracePath.empty() ){
+		cerr << "--trace needs a build with ECS_ENABLE_PROFILING=1" << endl;
+		return 1;
+	}
+#endif
+
+	auto start = chrono::steady_clock::now();
+	StressScenario scenario( config );
+	auto built = chrono::steady_clock::now();
+
+	for( size_t f = 0; f < frames; ++f ){
+		scenario.step();
+	}
+	auto done = chrono::steady_clock::now();
+
+	auto ms = []( chrono::steady_clock::duration d ){ return chrono::duration<double, milli>( d ).count(); };
+	auto stats = scenario.getManager()->getStats();
+
+	cout << fixed << setprecision( 3 );
+	cout << "entities:      " << stats.numEntities << endl;
+	cout << "ecs memory:    " << stats.getTotalBytes() / ( 1024.0 * 1024.0 ) << " MB" << endl;
+	cout << "resident:      " << getResidentBytes() / ( 1024.0 * 1024.0 ) << " MB" << endl;
+	cout << "build:         " << ms( built - start ) << " ms" << endl;
+	cout << "frames:        " << frames << " in " << ms( done - built ) << " ms, " << ms( done - built ) / max<size_t>( frames, 1 ) << " ms per frame" << endl;
+
+#if ECS_ENABLE_PROFILING
+	cout << endl << left << setw( 28 ) << "system" << right << setw( 12 ) << "avg ms" << setw( 12 ) << "max ms" << endl;
+
+	for( auto& t : scenario.getTimings() ){
+		cout << left << setw( 28 ) << t.first << right << setw( 12 ) << t.second.getAverageMicros() / 1000.0 << setw( 12 ) << t.second.maxMicros / 1000.0 << endl;
+	}
+
+	if( !tracePath.empty() ){
+		scenario.getManager()->getProfiler().exportChromeTrace( tracePath );
+	}
+#else
+	cout << endl << "build with ECS_ENABLE_PROFILING=1 for per system timings" << endl;
+#endif
+
+	return 0;
+}
@@ -59,6 +59,38 @@ void IDrawable::setDrawTarget( std::shared_ptr<ecs::DrawTarget> iDrawTarget){
 
 
 
+void IDrawable::setDrawableActive( bool active ){
+    
+    if( active == drawableActive ){
+        return;
+    }
+    
+    bool wasShown = isDrawableShown();
+    drawableActive = active;
+    updateDrawableShown( wasShown );
+}
+
+void IDrawable::setDrawableVisible( bool visible ){
+    
+    if( visible == drawableVisible ){
+        return;
+    }
+    
+    bool wasShown = isDrawableShown();
+    drawableVisible = visible;
+    updateDrawableShown( wasShown );
+}
+
+// drawn only while both active and visible, the draw target moves it when that changes
+void IDrawable::updateDrawableShown( bool wasShown ){
+    
+    bool shown = isDrawableShown();
+    if( shown != wasShown && drawTargetOwner ){
+        drawTargetOwner->setDrawableActive( this, shown );
+    }
+}
+
+
 IDrawable::~IDrawable(){
     
     if( hasDrawTarget() ){
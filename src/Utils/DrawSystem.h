@@ -31,9 +31,24 @@ namespace ecs{
         
         bool hasDrawTarget() { return (drawTargetOwner != nullptr);  }
         
+        // inactive drawables are kept aside by their draw target and not visited when drawing, see Entity::setActive
+        void setDrawableActive( bool active );
+        bool isDrawableActive() const { return drawableActive; }
+        
+        // same for hidden ones, see Transform::setVisible
+        void setDrawableVisible( bool visible );
+        bool isDrawableVisible() const { return drawableVisible; }
+        
     private:
+        
+        // whether the draw target keeps it in its drawn list
+        bool isDrawableShown() const { return drawableActive && drawableVisible; }
+        void updateDrawableShown( bool wasShown );
+        
         int drawTargetId = -1;
         bool isDirty = false;
+        bool drawableActive = true;
+        bool drawableVisible = true;
         DrawTarget* drawTargetOwner = nullptr;
         
         std::list<IDrawable*>::iterator _listPosition;
@@ -51,6 +66,12 @@ namespace ecs{
         }
         
         
+        // called by the DrawSystem, mDrawables only holds the active and visible drawables, in the order they were added
+        void render(){
+            sortDrawables();
+            draw();
+        }
+        
         // actually draw stuff
         virtual void draw(){
             
@@ -62,28 +83,65 @@ namespace ecs{
         
         void addDrawable( IDrawable* iDrawable ){
             
-            iDrawable->drawTargetId = mDrawables.size();
+            auto& drawables = iDrawable->isDrawableShown() ? mDrawables : mInactiveDrawables;
+            
+            iDrawable->drawTargetId = mNextDrawableId++;
             iDrawable->drawTargetOwner = this;
-            mDrawables.push_back( iDrawable );
+            drawables.push_back( iDrawable );
             
-            iDrawable->_listPosition =  -- ( mDrawables.end() );
+            iDrawable->_listPosition =  -- ( drawables.end() );
         }
         
         
         void removeDrawable( std::list<IDrawable*>::iterator& itPos ){
-            if( itPos != mDrawables.end() ){
+            if( itPos != mDrawables.end() && itPos != mInactiveDrawables.end() ){
                 auto obj = *itPos;
 
-                
-                if( mDrawables.size() > 0 ){
-                    mDrawables.erase( itPos );
+                auto& drawables = obj->isDrawableShown() ? mDrawables : mInactiveDrawables;
+                if( drawables.size() > 0 ){
+                    drawables.erase( itPos );
                 }
                 
                 obj->_listPosition = mDrawables.end();
 
             }
         }
+        
+        // moves the drawable between the drawn list and the inactive or hidden one, a splice so it's O(1)
+        void setDrawableActive( IDrawable* iDrawable, bool active ){
+            
+            auto itPos = iDrawable->_listPosition;
+            if( itPos == mDrawables.end() ){
+                return; // already removed
+            }
+            
+            if( active ){
+                mDrawables.splice( mDrawables.end(), mInactiveDrawables, itPos );
+                mNeedsSort = true;
+            }else{
+                mInactiveDrawables.splice( mInactiveDrawables.end(), mDrawables, itPos );
+            }
+        }
+        
         std::list<IDrawable*> mDrawables;
+        std::list<IDrawable*> mInactiveDrawables;
+        
+    protected:
+        
+        int mNextDrawableId = 0;
+        
+    private:
+        
+        // reactivated drawables are appended, put them back in the order they were added before drawing
+        void sortDrawables(){
+            
+            if( mNeedsSort ){
+                mDrawables.sort( []( const IDrawable* a, const IDrawable* b ){ return a->drawTargetId < b->drawTargetId; } );
+                mNeedsSort = false;
+            }
+        }
+        
+        bool mNeedsSort = false;
     };
     
     
@@ -107,7 +165,7 @@ namespace ecs{
         void draw() override{
             
             for(auto d : mDrawTargets){
-                d->draw();
+                d->render();
             }
             
         }
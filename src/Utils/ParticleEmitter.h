@@ -0,0 +1,298 @@
+//
+//  ParticleEmitter.h
+//
+//  Particles stored as a pool inside one component instead of an entity per
+//  particle: position, previous position, velocity and lifetime live in
+//  separate arrays ( SoA ), integrated four at a time with SSE where it's
+//  available, dead particles are reclaimed by swapping the last one into
+//  their slot. ParticleEmitterSystem updates every emitter, copies them into
+//  the render packet and draws them all with a single point batch.
+//
+
+#ifndef ParticleEmitter_h
+#define ParticleEmitter_h
+
+#include "ecs/Manager.h"
+#include "Utils/DrawSystem.h"
+
+#include "cinder/gl/gl.h"
+#include "cinder/gl/Vbo.h"
+#include "cinder/gl/VboMesh.h"
+#include "cinder/gl/Batch.h"
+#include "cinder/gl/GlslProg.h"
+
+#include <vector>
+#include <cmath>
+#include <cstddef>
+#include <algorithm>
+#include <initializer_list>
+
+#if defined( __SSE__ ) || defined( _M_X64 ) || ( defined( _M_IX86_FP ) && _M_IX86_FP >= 1 )
+    #define ECS_PARTICLES_SSE 1
+    #include <xmmintrin.h>
+#else
+    #define ECS_PARTICLES_SSE 0
+#endif
+
+
+struct ParticleEmitter : ecs::Component {
+
+    ParticleEmitter(){ }
+    ParticleEmitter( std::size_t capacity ){ reserve( capacity ); }
+
+    // velocity kept per 60hz frame and lifetime lost per 60hz frame, the integration scales both to the step
+    float damping = 0.94f;
+    float decay = 0.1f;
+
+    // emit() drops new particles past this count, 0 is unbounded
+    std::size_t maxParticles = 0;
+
+    void reserve( std::size_t capacity ){
+        for( auto array : { &mPosX, &mPosY, &mPrevX, &mPrevY, &mVelX, &mVelY, &mLife } ){
+            array->reserve( capacity );
+        }
+    }
+
+    bool emit( const ci::vec2& pos, const ci::vec2& vel, float lifetime ){
+
+        if( maxParticles != 0 && size() >= maxParticles ){
+            return false;
+        }
+
+        mPosX.push_back( pos.x );   mPosY.push_back( pos.y );
+        mPrevX.push_back( pos.x );  mPrevY.push_back( pos.y );
+        mVelX.push_back( vel.x );   mVelY.push_back( vel.y );
+        mLife.push_back( lifetime );
+        return true;
+    }
+
+    // advances every particle by `stepSeconds`
+    void integrate( float stepSeconds ){
+
+        const float frames = stepSeconds * 60.0f;
+        const float damp = std::pow( damping, frames );
+        const float loss = decay * frames;
+
+        const std::size_t n = size();
+        std::size_t i = 0;
+
+        float* posX = mPosX.data();  float* posY = mPosY.data();
+        float* prevX = mPrevX.data(); float* prevY = mPrevY.data();
+        float* velX = mVelX.data();  float* velY = mVelY.data();
+        float* life = mLife.data();
+
+#if ECS_PARTICLES_SSE
+        const __m128 vDamp = _mm_set1_ps( damp );
+        const __m128 vFrames = _mm_set1_ps( frames );
+        const __m128 vLoss = _mm_set1_ps( loss );
+
+        for( ; i + 4 <= n; i += 4 ){
+
+            __m128 px = _mm_loadu_ps( posX + i );
+            __m128 py = _mm_loadu_ps( posY + i );
+            _mm_storeu_ps( prevX + i, px );
+            _mm_storeu_ps( prevY + i, py );
+
+            __m128 vx = _mm_mul_ps( _mm_loadu_ps( velX + i ), vDamp );
+            __m128 vy = _mm_mul_ps( _mm_loadu_ps( velY + i ), vDamp );
+            _mm_storeu_ps( velX + i, vx );
+            _mm_storeu_ps( velY + i, vy );
+
+            _mm_storeu_ps( posX + i, _mm_add_ps( px, _mm_mul_ps( vx, vFrames ) ) );
+            _mm_storeu_ps( posY + i, _mm_add_ps( py, _mm_mul_ps( vy, vFrames ) ) );
+
+            _mm_storeu_ps( life + i, _mm_sub_ps( _mm_loadu_ps( life + i ), vLoss ) );
+        }
+#endif
+
+        // the tail, or everything without SSE, plain enough for the compiler to vectorize
+        for( ; i < n; ++i ){
+            prevX[i] = posX[i];
+            prevY[i] = posY[i];
+            velX[i] *= damp;
+            velY[i] *= damp;
+            posX[i] += velX[i] * frames;
+            posY[i] += velY[i] * frames;
+            life[i] -= loss;
+        }
+    }
+
+    // removes the dead particles by moving the last live ones into their slots, order isn't kept
+    void compact(){
+
+        std::size_t n = size();
+        std::size_t i = 0;
+
+        while( i < n ){
+
+            if( mLife[i] > 0.0f ){
+                ++i;
+                continue;
+            }
+
+            --n;
+            mPosX[i] = mPosX[n];    mPosY[i] = mPosY[n];
+            mPrevX[i] = mPrevX[n];  mPrevY[i] = mPrevY[n];
+            mVelX[i] = mVelX[n];    mVelY[i] = mVelY[n];
+            mLife[i] = mLife[n];
+        }
+
+        for( auto array : { &mPosX, &mPosY, &mPrevX, &mPrevY, &mVelX, &mVelY, &mLife } ){
+            array->resize( n );
+        }
+    }
+
+    void clear(){
+        for( auto array : { &mPosX, &mPosY, &mPrevX, &mPrevY, &mVelX, &mVelY, &mLife } ){
+            array->clear();
+        }
+    }
+
+    std::size_t size() const { return mLife.size(); }
+    bool empty() const { return mLife.empty(); }
+
+    ci::vec2 getPos( std::size_t i ) const { return ci::vec2( mPosX[i], mPosY[i] ); }
+    ci::vec2 getPrevPos( std::size_t i ) const { return ci::vec2( mPrevX[i], mPrevY[i] ); }
+    ci::vec2 getVelocity( std::size_t i ) const { return ci::vec2( mVelX[i], mVelY[i] ); }
+    float getLifetime( std::size_t i ) const { return mLife[i]; }
+
+    const float* getPosX() const { return mPosX.data(); }
+    const float* getPosY() const { return mPosY.data(); }
+    const float* getPrevX() const { return mPrevX.data(); }
+    const float* getPrevY() const { return mPrevY.data(); }
+    const float* getLifetimes() const { return mLife.data(); }
+
+protected:
+
+    std::vector<float> mPosX, mPosY;
+    std::vector<float> mPrevX, mPrevY;
+    std::vector<float> mVelX, mVelY;
+    std::vector<float> mLife;
+};
+
+
+// one point of the render packet, interleaved for the vbo
+struct ParticleVertex {
+    ci::vec2 prevPos;
+    ci::vec2 pos;
+    float size;
+};
+
+
+struct ParticleEmitterSystem : public ecs::System, public ecs::IDrawable {
+
+    // point size in pixels per unit of lifetime, and its upper bound
+    float sizeScale = 2.0f;
+    float maxSize = 40.0f;
+
+    void setup() override {
+        setDrawable( false );
+    }
+
+    void update() override {
+
+        float step = static_cast<float>( getManager()->getFrameTime()->stepSeconds );
+
+        for( auto emitter : getManager()->getActiveComponentsSpan<ParticleEmitter>() ){
+            emitter->integrate( step );
+            emitter->compact();
+        }
+    }
+
+    void extract( ecs::RenderPacket& packet ) override {
+
+        auto& vertices = packet.get<ParticleVertex>();
+
+        for( auto emitter : getManager()->getActiveComponentsSpan<ParticleEmitter>() ){
+
+            auto n = emitter->size();
+            auto first = vertices.size();
+            vertices.resize( first + n );
+
+            auto posX = emitter->getPosX();     auto posY = emitter->getPosY();
+            auto prevX = emitter->getPrevX();   auto prevY = emitter->getPrevY();
+            auto life = emitter->getLifetimes();
+
+            for( std::size_t i = 0; i < n; ++i ){
+                auto& v = vertices[first + i];
+                v.prevPos = ci::vec2( prevX[i], prevY[i] );
+                v.pos = ci::vec2( posX[i], posY[i] );
+                v.size = std::min( life[i] * sizeScale, maxSize );
+            }
+        }
+    }
+
+    // only reads the render packet, so it's safe to draw while the manager simulates the next frame
+    void draw() override {
+
+        const auto& packet = getManager()->getRenderPacket();
+        auto vertices = packet.find<ParticleVertex>();
+        if( vertices == nullptr || vertices->empty() ){
+            return;
+        }
+
+        upload( *vertices );
+
+        ci::gl::ScopedState pointSize( GL_PROGRAM_POINT_SIZE, true );
+        mBatch->getGlslProg()->uniform( "uAlpha", static_cast<float>( packet.frameTime.alpha ) );
+        mBatch->draw( 0, static_cast<GLsizei>( vertices->size() ) );
+    }
+
+protected:
+
+    // the vbo grows by doubling and is rewritten every frame, the batch is only rebuilt when it grows
+    void upload( const std::vector<ParticleVertex>& vertices ){
+
+        auto bytes = vertices.size() * sizeof( ParticleVertex );
+
+        if( !mBatch || vertices.size() > mCapacity ){
+
+            mCapacity = std::max<std::size_t>( vertices.size(), mCapacity * 2 );
+            mVbo = ci::gl::Vbo::create( GL_ARRAY_BUFFER, mCapacity * sizeof( ParticleVertex ), nullptr, GL_STREAM_DRAW );
+
+            ci::geom::BufferLayout layout;
+            layout.append( ci::geom::Attrib::CUSTOM_0, 2, sizeof( ParticleVertex ), offsetof( ParticleVertex, prevPos ) );
+            layout.append( ci::geom::Attrib::POSITION, 2, sizeof( ParticleVertex ), offsetof( ParticleVertex, pos ) );
+            layout.append( ci::geom::Attrib::CUSTOM_1, 1, sizeof( ParticleVertex ), offsetof( ParticleVertex, size ) );
+
+            auto mesh = ci::gl::VboMesh::create( static_cast<uint32_t>( mCapacity ), GL_POINTS, { { layout, mVbo } } );
+            mBatch = ci::gl::Batch::create( mesh, getGlsl(), { { ci::geom::Attrib::CUSTOM_0, "aPrevPosition" }, { ci::geom::Attrib::CUSTOM_1, "aSize" } } );
+        }
+
+        mVbo->bufferSubData( 0, bytes, vertices.data() );
+    }
+
+    static ci::gl::GlslProgRef getGlsl(){
+
+        static ci::gl::GlslProgRef glsl = ci::gl::GlslProg::create( ci::gl::GlslProg::Format()
+            .vertex( CI_GLSL( 150,
+                uniform mat4 ciModelViewProjection;
+                uniform float uAlpha;
+                in vec4 ciPosition;
+                in vec4 ciColor;
+                in vec2 aPrevPosition;
+                in float aSize;
+                out vec4 vColor;
+                void main(){
+                    vColor = ciColor;
+                    gl_PointSize = aSize;
+                    gl_Position = ciModelViewProjection * vec4( mix( aPrevPosition, ciPosition.xy, uAlpha ), 0.0, 1.0 );
+                }
+            ) )
+            .fragment( CI_GLSL( 150,
+                in vec4 vColor;
+                out vec4 oColor;
+                void main(){
+                    oColor = vColor;
+                }
+            ) ) );
+
+        return glsl;
+    }
+
+    std::size_t mCapacity = 0;
+    ci::gl::VboRef mVbo;
+    ci::gl::BatchRef mBatch;
+};
+
+#endif /* ParticleEmitter_h */
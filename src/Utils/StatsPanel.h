@@ -0,0 +1,66 @@
+//
+//  StatsPanel.h
+//
+//  ImGui window showing the memory and allocation stats of a Manager.
+//
+
+#ifndef StatsPanel_h
+#define StatsPanel_h
+
+#include "ecs/Manager.h"
+
+#include "cinder/System.h"
+#include "CinderImGui.h"
+
+namespace ImGui{
+    
+    inline void DrawManagerStats( const ecs::Manager& iManager, bool* open = nullptr ){
+        
+        auto stats = iManager.getStats();
+        
+        if( !ui::Begin( "ECS Memory", open ) ){
+            ui::End();
+            return;
+        }
+        
+        auto kb = []( size_t bytes ){ return bytes / 1024.0f; };
+        
+        ui::Text( "total: %.1f KB", kb( stats.getTotalBytes() ) );
+        ui::Text( "allocations / frees last frame: %zu / %zu", stats.allocationsLastFrame, stats.freesLastFrame );
+        ui::Separator();
+        
+        ui::Text( "entities: %zu ( %.1f KB )", stats.numEntities, kb( stats.entityBytes ) );
+        ui::Text( "entity table: %zu records, %zu free ( %.0f%% ), %.1f KB", stats.entityTableRecords, stats.entityTableFree, stats.entityTableFragmentation * 100.0f, kb( stats.entityTableBytes ) );
+        ui::Text( "factories: %.1f KB", kb( stats.factoryBytes ) );
+        ui::Text( "frame arena: %.1f / %.1f KB", kb( stats.arenaBytesUsed ), kb( stats.arenaCapacity ) );
+        ui::Text( "resources: %zu  observers: %zu", stats.numResources, stats.numObservers );
+        ui::Separator();
+        
+        ui::Columns( 7, "ecs_memory_types" );
+        ui::Text( "type" );         ui::NextColumn();
+        ui::Text( "live" );         ui::NextColumn();
+        ui::Text( "capacity" );     ui::NextColumn();
+        ui::Text( "KB" );           ui::NextColumn();
+        ui::Text( "allocs" );       ui::NextColumn();
+        ui::Text( "frees" );        ui::NextColumn();
+        ui::Text( "frag" );         ui::NextColumn();
+        ui::Separator();
+        
+        for( auto& c : stats.components ){
+            
+            auto name = ci::System::demangleTypeName( c.name.c_str() );
+            ui::Text( "%s", name.c_str() );                             ui::NextColumn();
+            ui::Text( "%zu", c.liveCount );                             ui::NextColumn();
+            ui::Text( "%zu", c.capacity );                              ui::NextColumn();
+            ui::Text( "%.1f", kb( c.bytes ) );                          ui::NextColumn();
+            ui::Text( "%zu", c.allocationsLastFrame );                  ui::NextColumn();
+            ui::Text( "%zu", c.freesLastFrame );                        ui::NextColumn();
+            ui::Text( "%.0f%%", c.fragmentation * 100.0f );             ui::NextColumn();
+        }
+        
+        ui::Columns( 1 );
+        ui::End();
+    }
+}
+
+#endif /* StatsPanel_h */
@@ -8,20 +8,39 @@
 #include "Transform.h"
 #include "ecs/Manager.h"
 
+#include <unordered_map>
+
 using namespace ci;
 using namespace glm;
 
 
 size_t Transform::transformId = 0;
 
+namespace {
+    
+    // the entity and its components can double as drawables, hidden transforms take them out of their draw target
+    void setDrawablesVisible( Transform* transform, bool visible ){
+        
+        auto entity = transform->getEntity().lock();
+        if( !entity ){
+            return;
+        }
+        
+        if( auto drawable = dynamic_cast<ecs::IDrawable*>( entity.get() ) ){
+            drawable->setDrawableVisible( visible );
+        }
+        for( auto component : entity->getComponentsSpan() ){
+            if( auto drawable = dynamic_cast<ecs::IDrawable*>( component ) ){
+                drawable->setDrawableVisible( visible );
+            }
+        }
+    }
+}
 
 
 Transform::Transform(){
     mId = transformId;
     transformId++;
-    
-    
-    onUpdateSignal = std::make_shared<ci::signals::Signal<void(const Transform*)>>();
 }
 
 Transform::Transform( const vec3& pos_ ) : localPos(pos_){
@@ -36,53 +55,139 @@ Transform::Transform( const Transform& other ){
     
     
     localPos = other.localPos;
-    rotation = other.rotation;
+    mRotation = other.mRotation;
     localScale = other.localScale;
+    mEnabled = other.mEnabled;
+    mVisible = other.mVisible;
     
     
     if( other.hasParent() ){
         this->setParent( other.getParent() );
     }
+    
+    // a copy without a parent still has to derive its own effective flags from the copied ones
+    propagateHierarchyFlags();
     updateMatrices();
 }
 
 Transform::~Transform(){
+}
+
+void Transform::setup(){
+    
+    markHierarchyDirty();
     
+    // hidden before being added, the drawables the entity already has go aside
+    if( !mVisibleInHierarchy ){
+        setDrawablesVisible( this, false );
+    }
+    
+    // flagged before being added to the manager
+    if( mAlwaysUpdate ){
+        TransformHierarchy::get( mManager )->countAlwaysUpdate( true );
+    }
+}
+
+void Transform::setAlwaysUpdate( bool v ){
     
-    children.clear();
+    if( v != mAlwaysUpdate && mManager ){
+        TransformHierarchy::get( mManager )->countAlwaysUpdate( v );
+    }
     
+    mAlwaysUpdate = v;
 }
 
 
-void Transform::updateMatrices(bool emitSignal){
+void Transform::updateMatrices(){
     
-    // TODO: Cache the matrices transformss
+    // updateNode reads the parent's world matrix as is, bring an edited parent up to date first
+    if( parent && ( parent->mNeedsUpdate || parent->mParentChanged ) ){
+        parent->updateFromEditedAncestor();
+    }
     
-    ci::mat4 transform;
-    transform *= glm::translate<float>( localPos + anchorPoint);
-    transform *= glm::toMat4<float>( mRotation ); //glm::rotate(localRotation, vec3(0,0,1));
-    transform *= glm::scale<float>( localScale );
-    transform *= glm::translate<float>( -anchorPoint );
+    updateSubtree( mManager ? TransformChanges::get( mManager ) : nullptr, nullptr );
+}
+
+void Transform::updateSubtree( TransformChanges* changes, std::vector<Transform*>* collected ){
     
-    mCTransform = transform;
+    updateNode( changes, collected );
+
+    // disabled branches are pruned here, they catch up when enabled again
+    for(auto c = mFirstChild; c != nullptr; c = c->mNextSibling){
+        if( c->mEnabled ){
+            c->updateSubtree( changes, collected );
+        }
+    }
+}
+
+void Transform::updateNode( TransformChanges* changes, std::vector<Transform*>* collected ){
+    
+    mCTransform = computeLocalTransform();
     
     if(parent)
     {
-        mWorldTransform = parent->getWorldTransform() * mCTransform;
+        // the parent is current here, callers update parents first ( updateMatrices, updatePathFromAncestors, the
+        // TransformSystem's roots ), so this never writes another node and is safe on the worker threads
+        storeWorldTransform( parent->mWorldTransform * mCTransform );
     }else{
-        mWorldTransform = mCTransform;
+        storeWorldTransform( mCTransform );
     }
+    cacheWorldState();
     
-    if( onUpdateSignal && onUpdateSignal->getNumSlots() != 0){
-        onUpdateSignal->emit( this );
+    if( collected ){
+        collected->push_back( this );
+    }else if( changes ){
+        changes->add( this );
     }
     
     mNeedsUpdate = false;
+    mParentChanged = false;
+    markChanged();
+}
+
+void Transform::updateFromEditedAncestor(){
+    
+    // climb to the edited ancestor, its subtree update covers this node
+    auto origin = this;
+    while( origin->mParentChanged && origin->parent ){
+        origin = origin->parent;
+    }
+    origin->updateMatrices();
+    
+    // the subtree update prunes disabled branches, a node inside one still gets its own path recomputed
+    if( mParentChanged ){
+        updatePathFromAncestors();
+    }
+}
+
+void Transform::updatePathFromAncestors(){
+    
+    if( parent && ( parent->mParentChanged || parent->mNeedsUpdate ) ){
+        parent->updatePathFromAncestors();
+    }
+    updateNode( mManager ? TransformChanges::get( mManager ) : nullptr, nullptr );
+}
 
-    for(auto& c : children){
-        c->updateMatrices();
+// a flagged child already has its own subtree flagged, repeated edits in a frame stop there
+void Transform::invalidateDescendants(){
+    
+    for( auto c = mFirstChild; c != nullptr; c = c->mNextSibling ){
+        if( !c->mParentChanged ){
+            c->mParentChanged = true;
+            c->invalidateDescendants();
+        }
     }
+}
 
+mat4 Transform::computeLocalTransform() const {
+    
+    ci::mat4 transform;
+    transform *= glm::translate<float>( localPos + anchorPoint);
+    transform *= glm::toMat4<float>( mRotation ); //glm::rotate(localRotation, vec3(0,0,1));
+    transform *= glm::scale<float>( localScale );
+    transform *= glm::translate<float>( -anchorPoint );
+    
+    return transform;
 }
 
 // CTransformation Functions ------
@@ -93,14 +198,100 @@ void Transform::setCTransform(const mat4 &transform){
     if(parent)
     {
         
-        mWorldTransform = parent->getWorldTransform() * mCTransform;
+        storeWorldTransform( parent->getWorldTransform() * mCTransform );
+        
+    }else{
         
+        storeWorldTransform( mCTransform );
+    }
+    cacheWorldState();
+
+    setNeedsUpdate();
+}
+
+// the parent's cache is current here, its world matrix was just read
+void Transform::cacheWorldState(){
+    
+    vec4 p = mWorldTransform * vec4(anchorPoint, 1);
+    mWorldPos = vec3(p.x, p.y, p.z);
+    
+    if(parent)
+    {
+        mWorldRotation = mRotation * parent->mWorldRotation;
+        mWorldScale = parent->mWorldScale * localScale;
     }else{
+        mWorldRotation = mRotation;
+        mWorldScale = localScale;
+    }
+}
+
+// Interpolation -------
+
+namespace {
+    
+    // blends two affine matrices: translation and scale linearly, rotation with a slerp
+    mat4 interpolateAffine( const mat4& a, const mat4& b, float t ){
+        
+        vec3 scaleA( glm::length( vec3( a[0] ) ), glm::length( vec3( a[1] ) ), glm::length( vec3( a[2] ) ) );
+        vec3 scaleB( glm::length( vec3( b[0] ) ), glm::length( vec3( b[1] ) ), glm::length( vec3( b[2] ) ) );
+        
+        const float epsilon = 1e-6f;
+        if( glm::min( glm::min( scaleA.x, scaleA.y ), scaleA.z ) < epsilon || glm::min( glm::min( scaleB.x, scaleB.y ), scaleB.z ) < epsilon ){
+            return a + ( b - a ) * t; // degenerate basis, no rotation to extract
+        }
+        
+        glm::quat rotA = glm::quat_cast( mat3( vec3( a[0] ) / scaleA.x, vec3( a[1] ) / scaleA.y, vec3( a[2] ) / scaleA.z ) );
+        glm::quat rotB = glm::quat_cast( mat3( vec3( b[0] ) / scaleB.x, vec3( b[1] ) / scaleB.y, vec3( b[2] ) / scaleB.z ) );
+        
+        vec3 scale = glm::mix( scaleA, scaleB, t );
+        
+        mat4 result = glm::toMat4( glm::slerp( rotA, rotB, t ) );
+        result[0] *= scale.x;
+        result[1] *= scale.y;
+        result[2] *= scale.z;
+        result[3] = glm::mix( a[3], b[3], t );
         
-        mWorldTransform = mCTransform;
+        return result;
     }
+}
+
+void Transform::storeWorldTransform( const mat4& world ){
+    
+    auto frameTime = mManager ? mManager->getFrameTime() : nullptr;
+    std::uint64_t step = frameTime ? frameTime->step : 0;
+    
+    // the first write of a step keeps the value the previous step ended with
+    if( !mHasPrevWorldTransform ){
+        mPrevWorldTransform = world;
+        mHasPrevWorldTransform = true;
+    }else if( step != mWorldTransformStep ){
+        mPrevWorldTransform = mWorldTransform;
+    }
+    
+    mWorldTransformStep = step;
+    mWorldTransform = world;
+}
 
-    mNeedsUpdate = true;
+mat4 Transform::getInterpolatedWorldTransform(){
+    
+    // reads the live transform, with a pipelined manager only extract() may call it
+    assert( mManager == nullptr || !mManager->isSimulationInFlight() );
+    
+    auto world = getWorldTransform();
+    
+    if( mManager == nullptr || !mManager->isFixedTimestep() ){
+        return world;
+    }
+    
+    // the frame time published for drawing, the live one may already be a step ahead
+    const auto& frameTime = mManager->getRenderPacket().frameTime;
+    
+    // only transforms written during the last step moved, everything else rests on its current value
+    if( mWorldTransformStep != frameTime.step ){
+        return world;
+    }
+    
+    return interpolateAffine( mPrevWorldTransform, world, static_cast<float>( frameTime.alpha ) );
 }
 
 
@@ -108,12 +299,9 @@ void Transform::setCTransform(const mat4 &transform){
 
 vec3 Transform::getWorldPos() {
     
-    if( needsUpdate() ){
-        updateMatrices(false);
-    }
+    resolveWorldState();
 
-    vec4 p = mWorldTransform * vec4(anchorPoint, 1);
-    return vec3(p.x, p.y, p.z);
+    return mWorldPos;
 }
 
 
@@ -129,7 +317,7 @@ void Transform::setWorldPos(const vec3& pos){
     
     localPos -= anchorPoint;
     
-    mNeedsUpdate = true;
+    setNeedsUpdate();
 }
 
 // Scale -------
@@ -139,28 +327,21 @@ void Transform::setWorldScale(const vec3& scale){
     if(parent)
     {
         vec3 invScale = (1.0f /  parent->getWorldScale() );
-        localScale =  localScale *  invScale;
+        localScale =  scale *  invScale;
     }
     else
     {
         localScale = scale;
     }
 
-    mNeedsUpdate = true;
+    setNeedsUpdate();
 }
 
 vec3 Transform::getWorldScale() {
 
-    if( needsUpdate() ){
-        updateMatrices(false);
-    }
+    resolveWorldState();
     
-    if(parent)
-    {
-        return parent->getWorldScale() * localScale;
-    }else{
-        return localScale;
-    }
+    return mWorldScale;
 }
 
 // Rotation -------
@@ -178,7 +359,7 @@ void Transform::setWorldRotation( float radians ){
         mRotation = q;
     }
     
-    mNeedsUpdate = true;
+    setNeedsUpdate();
 }
 
 void Transform::setWorldRotation(const glm::quat& q ){
@@ -192,21 +373,62 @@ void Transform::setWorldRotation(const glm::quat& q ){
         mRotation = q;
     }
     
-    mNeedsUpdate = true;
+    setNeedsUpdate();
 }
 
 glm::quat Transform::getWorldRotation() {
     
-    if( needsUpdate() ){
-        updateMatrices(false);
+    resolveWorldState();
+
+    return mWorldRotation;
+}
+
+// Enabled / visible -------
+
+void Transform::setEnabled( bool enabled ){
+    
+    if( enabled == mEnabled ){
+        return;
+    }
+    
+    mEnabled = enabled;
+    propagateHierarchyFlags();
+    
+    // the matrices of the subtree went stale while it was disabled
+    if( mEnabledInHierarchy ){
+        setNeedsUpdate();
+    }
+}
+
+void Transform::setVisible( bool visible ){
+    
+    if( visible == mVisible ){
+        return;
     }
+    
+    mVisible = visible;
+    propagateHierarchyFlags();
+}
 
+void Transform::propagateHierarchyFlags(){
     
-    if(parent)
-    {
-        return mRotation * parent->getWorldRotation();
-    }else{
-        return mRotation;
+    bool enabled = mEnabled && ( parent == nullptr || parent->mEnabledInHierarchy );
+    bool visible = mVisible && ( parent == nullptr || parent->mVisibleInHierarchy );
+    
+    // descendants only depend on their ancestors, if nothing changed here the subtree is already right
+    if( enabled == mEnabledInHierarchy && visible == mVisibleInHierarchy ){
+        return;
+    }
+    
+    mEnabledInHierarchy = enabled;
+    
+    if( visible != mVisibleInHierarchy ){
+        mVisibleInHierarchy = visible;
+        setDrawablesVisible( this, visible );
+    }
+    
+    for( auto c = mFirstChild; c != nullptr; c = c->mNextSibling ){
+        c->propagateHierarchyFlags();
     }
 }
 
@@ -217,8 +439,15 @@ void Transform::setParent( Transform* _parent, bool keepWorldCTransform)
         return;
     }
     
-    parent = _parent;
-    parent->addChildToList( this );
+    if( parent != _parent ){
+        
+        if( parent ){
+            parent->removeChildFromList( this );
+        }
+        
+        _parent->addChildToList( this );
+        parent = _parent;
+    }
     
     if( keepWorldCTransform ){
         setWorldPos( localPos );
@@ -226,13 +455,15 @@ void Transform::setParent( Transform* _parent, bool keepWorldCTransform)
         setWorldRotation(mRotation);
     }
     
-    mNeedsUpdate = true;
+    propagateHierarchyFlags();
+    markHierarchyDirty();
+    setNeedsUpdate();
 }
 
 
 void Transform::removeParent(bool keepWordCTransform, bool removeFromList){
 
-    if( removeFromList ){
+    if( removeFromList && parent ){
         parent->removeChildFromList( this );
     }
     //TODO clenup
@@ -240,7 +471,7 @@ void Transform::removeParent(bool keepWordCTransform, bool removeFromList){
     
     if(p && keepWordCTransform){
         
-        auto newPos =  mWorldTransform * vec4(0,0, 0, 1);
+        auto newPos =  getWorldTransform() * vec4(0,0, 0, 1);
         localPos = vec3( newPos.x, newPos.y, newPos.z );
         
         auto newScale =  localScale * p->getWorldScale();
@@ -253,37 +484,43 @@ void Transform::removeParent(bool keepWordCTransform, bool removeFromList){
     
     parent = nullptr;
 
-    mNeedsUpdate = true;
+    propagateHierarchyFlags();
+    markHierarchyDirty();
+    setNeedsUpdate();
 }
 
 Transform* Transform::findChild(const Transform* child ){
     
     
-    if( child == nullptr ){
+    // a child is linked into its parent's list for as long as its parent pointer is set
+    if( child == nullptr || child->parent != this ){
         return nullptr;
     }
     
-    auto iter = std::find_if(children.begin(), children.end(), [child](const Transform* handle) -> bool {
-        return (handle != nullptr) && (handle == child);
-    });
+    return const_cast<Transform*>( child );
+}
+
+std::vector<Transform*> Transform::getChildren() const {
     
-    if( iter == children.end() ){
-        return nullptr;
+    std::vector<Transform*> result;
+    result.reserve( mNumChildren );
+    for( auto c = mFirstChild; c != nullptr; c = c->mNextSibling ){
+        result.push_back( c );
     }
-    
-    return *iter;
+    return result;
 }
 
 
 
 bool Transform::addChild(Transform* transform){
 
-    bool alreadyInTree = transform->hasChild( this ) || hasChild(transform);
+    // adding ourselves or one of our ancestors would make a cycle
+    bool invalid = transform == this || transform->parent == this || transform->isAncestorOf( this );
     
-    if ( !alreadyInTree ){
+    if ( !invalid ){
         
         transform->setParent( this );
-        transform->mNeedsUpdate = true;
+        transform->setNeedsUpdate();
         
         return true;
     }else{
@@ -307,52 +544,313 @@ bool Transform::removeChild( Transform* transform ){
 
 bool Transform::hasChild(const Transform* child, bool recursive ){
     
-    auto found = findChild(child);
+    if( recursive ){
+        return isAncestorOf( child );
+    }
     
-    if( found ){
-        return true;
+    return findChild(child) != nullptr;
+}
+
+bool Transform::isAncestorOf( const Transform* other ) const {
+    
+    if( other == nullptr || other == this ){
+        return false;
+    }
+    
+    auto hierarchy = mManager ? TransformHierarchy::get( mManager ) : nullptr;
+    if( hierarchy && !hierarchy->isDirty() && mTourVersion == hierarchy->getVersion() && other->mTourVersion == hierarchy->getVersion() ){
+        return mTourEnter < other->mTourEnter && other->mTourEnter <= mTourExit;
+    }
+    
+    for( auto p = other->parent; p != nullptr; p = p->parent ){
+        if( p == this ){
+            return true;
+        }
+    }
+    
+    return false;
+}
+
+void Transform::markHierarchyDirty(){
+    
+    if( mManager ){
+        TransformHierarchy::get( mManager )->markDirty();
+    }
+}
+
+// Hierarchy -------
+
+TransformHierarchy* TransformHierarchy::get( ecs::Manager* manager ){
+    
+    auto hierarchy = manager->getResource<TransformHierarchy>();
+    if( hierarchy == nullptr ){
+        hierarchy = manager->setResource<TransformHierarchy>();
+    }
+    return hierarchy;
+}
+
+void TransformHierarchy::update( ecs::Manager& manager ){
+    
+    if( mDirty ){
+        rebuild( manager.getComponentsArray<Transform>() );
     }
+}
+
+void TransformHierarchy::rebuild( const std::vector<Transform*>& transforms ){
     
-    if( recursive  ){
-        for( auto& c : children  ){
+    ++mVersion;
+    mOrder.clear();
+    mOrder.reserve( transforms.size() );
+    
+    std::uint32_t counter = 0;
+    
+    // iterative so deep trees can't overflow the stack
+    std::vector< std::pair<Transform*, Transform*> > stack; // node, next child to visit
+    
+    for( auto root : transforms ){
+        
+        if( root->parent != nullptr ){
+            continue;
+        }
+        
+        root->mTourEnter = counter++;
+        root->mTourVersion = mVersion;
+        mOrder.push_back( root );
+        stack.emplace_back( root, root->mFirstChild );
+        
+        while( !stack.empty() ){
+            
+            auto& top = stack.back();
+            auto node = top.first;
             
-            if(  c->hasChild( this ) ){
-                return true;
+            if( top.second != nullptr ){
+                
+                auto child = top.second;
+                top.second = child->mNextSibling;
+                child->mTourEnter = counter++;
+                child->mTourVersion = mVersion;
+                mOrder.push_back( child );
+                stack.emplace_back( child, child->mFirstChild );
+                
+            }else{
+                
+                node->mTourExit = counter - 1;
+                stack.pop_back();
             }
         }
     }
-   
-    return false;
+    
+    mDirty = false;
 }
 
 
-bool Transform::removeChildFromList( Transform* child){
+// Reparent batch -------
+
+namespace {
+    
+    // world values the way getWorldTransform, getWorldRotation and getWorldScale compose them
+    struct WorldState {
+        mat4 transform;
+        quat rotation;
+        vec3 scale{ 1.0f };
+    };
+    
+    typedef std::unordered_map<const Transform*, WorldState> WorldCache;
+}
+
+void TransformReparentBatch::apply(){
+    
+    if( mOps.empty() ){
+        return;
+    }
+    
+    // a child recorded more than once only keeps its last operation
+    std::unordered_map<const Transform*, std::size_t> lastOp;
+    for( std::size_t i = 0; i < mOps.size(); ++i ){
+        if( mOps[i].child ){
+            lastOp[ mOps[i].child ] = i;
+        }
+    }
+    
+    std::vector<Transform*> chain;
+    
+    // resolves `t` from its closest cached ancestor down, so every node is composed once per cache
+    auto resolve = [&chain]( WorldCache& cache, Transform* t ) -> WorldState {
+        
+        chain.clear();
+        for( auto node = t; node != nullptr && cache.find( node ) == cache.end(); node = node->parent ){
+            chain.push_back( node );
+        }
+        
+        for( auto it = chain.rbegin(); it != chain.rend(); ++it ){
+            
+            auto node = *it;
+            auto local = node->computeLocalTransform();
+            
+            WorldState world;
+            if( node->parent ){
+                const auto& p = cache[ node->parent ];
+                world.transform = p.transform * local;
+                world.rotation = node->mRotation * p.rotation;
+                world.scale = p.scale * node->localScale;
+            }else{
+                world.transform = local;
+                world.rotation = node->mRotation;
+                world.scale = node->localScale;
+            }
+            cache[ node ] = world;
+        }
+        
+        return cache[ t ];
+    };
+    
+    // capture the world state to keep, before anything moves
+    WorldCache before;
+    std::vector<WorldState> captured( mOps.size() );
+    
+    for( std::size_t i = 0; i < mOps.size(); ++i ){
+        if( mOps[i].child && lastOp[ mOps[i].child ] == i && mOps[i].keepWorldTransform ){
+            captured[i] = resolve( before, mOps[i].child );
+        }
+    }
     
-    auto findIt = findChild(child);
+    // relink, in order so cycles are judged against the edits before them
+    std::vector<std::size_t> applied;
+    applied.reserve( mOps.size() );
     
-    if( findIt ){
+    for( std::size_t i = 0; i < mOps.size(); ++i ){
+        
+        auto& op = mOps[i];
+        if( op.child == nullptr || lastOp[ op.child ] != i || op.child->parent == op.parent ){
+            continue;
+        }
         
-        auto rmFn = [child](const Transform* t ) -> bool{
-            return child == t;
-        };
+        bool invalid = false;
+        for( auto p = op.parent; p != nullptr; p = p->parent ){
+            if( p == op.child ){
+                invalid = true;
+                break;
+            }
+        }
         
-        children.erase(  std::remove_if( children.begin(), children.end(), rmFn ), children.end() );
+        if( invalid ){
+            continue;
+        }
         
-        return true;
+        if( op.child->parent ){
+            op.child->parent->removeChildFromList( op.child );
+        }
+        if( op.parent ){
+            op.parent->addChildToList( op.child );
+        }
+        op.child->parent = op.parent;
+        
+        applied.push_back( i );
+    }
+    
+    // moved nodes that keep their world state are seeded with it, their new locals are solved against the new parents
+    WorldCache after;
+    for( auto i : applied ){
+        if( mOps[i].keepWorldTransform ){
+            after[ mOps[i].child ] = captured[i];
+        }
+    }
+    
+    for( auto i : applied ){
+        
+        auto& op = mOps[i];
+        if( !op.keepWorldTransform ){
+            continue;
+        }
+        
+        auto child = op.child;
+        const auto& world = captured[i];
+        auto worldPos = vec3( world.transform * vec4( child->anchorPoint, 1 ) );
+        
+        if( op.parent ){
+            auto p = resolve( after, op.parent );
+            child->localPos = vec3( glm::inverse( p.transform ) * vec4( worldPos, 1 ) ) - child->anchorPoint;
+            child->mRotation = world.rotation * glm::inverse( p.rotation );
+            child->localScale = world.scale / p.scale;
+        }else{
+            child->localPos = worldPos - child->anchorPoint;
+            child->mRotation = world.rotation;
+            child->localScale = world.scale;
+        }
+    }
+    
+    for( auto i : applied ){
+        mOps[i].child->propagateHierarchyFlags();
+        mOps[i].child->setNeedsUpdate();
+    }
+    
+    mOps.clear();
+    
+    if( mManager && !applied.empty() ){
+        auto hierarchy = TransformHierarchy::get( mManager );
+        hierarchy->markDirty();
+        hierarchy->update( *mManager );
     }
-    return false;
 }
 
-bool Transform::addChildToList( Transform* child){
+// Changes -------
+
+TransformChanges* TransformChanges::get( ecs::Manager* manager ){
     
-    auto findIt = findChild( child );
+    auto changes = manager->getResource<TransformChanges>();
+    if( changes == nullptr ){
+        changes = manager->setResource<TransformChanges>();
+    }
+    return changes;
+}
+
+void TransformChanges::add( Transform* transform ){
     
-    if( ! findIt ){
-        children.push_back(child);
-        return true;
+    if( transform->mChangeGeneration == mGeneration ){
+        return;
     }
     
-    return false;
+    transform->mChangeGeneration = mGeneration;
+    transform->mChangeIndex = mChanged.size();
+    mChanged.push_back( transform );
+}
+
+void TransformChanges::remove( Transform* transform ){
+    
+    if( transform->mChangeGeneration == mGeneration && mChanged[ transform->mChangeIndex ] == transform ){
+        mChanged[ transform->mChangeIndex ] = nullptr;
+    }
+}
+
+bool Transform::removeChildFromList( Transform* child){
+    
+    if( !findChild(child) ){
+        return false;
+    }
+    
+    ( child->mPrevSibling ? child->mPrevSibling->mNextSibling : mFirstChild ) = child->mNextSibling;
+    ( child->mNextSibling ? child->mNextSibling->mPrevSibling : mLastChild ) = child->mPrevSibling;
+    
+    child->mPrevSibling = child->mNextSibling = nullptr;
+    mNumChildren--;
+    
+    return true;
+}
+
+bool Transform::addChildToList( Transform* child){
+    
+    // called before the child's parent is set, see setParent
+    if( findChild( child ) ){
+        return false;
+    }
+    
+    child->mPrevSibling = mLastChild;
+    child->mNextSibling = nullptr;
+    ( mLastChild ? mLastChild->mNextSibling : mFirstChild ) = child;
+    mLastChild = child;
+    mNumChildren++;
+    
+    return true;
 }
 
 Transform* Transform::getRoot(){
@@ -368,10 +866,13 @@ Transform* Transform::getRoot(){
 
 void Transform::descendTree(const std::function<void (Transform* &, Transform* &)> &fn){
     
-    for( auto &c : children ) {
+    for( auto c = mFirstChild; c != nullptr; ) {
+        auto next = c->mNextSibling; // fn may reparent c
         auto thisHandle = this;
-        fn(thisHandle,  c);
+        auto child = c;
+        fn(thisHandle,  child);
         c->descendTree(fn);
+        c = next;
     }
     
 }
@@ -411,9 +912,8 @@ ecs::EntityRef ImGui::DrawTree(const Transform* iTransform){
             }
             
             if( nodeOpen ){
-                for( auto &child : root->getChildren() ) {
-                    auto ptr = child;
-                    drawChildren( ptr );
+                for( auto child : root->getChildrenRange() ) {
+                    drawChildren( child );
                 }
                 ImGui::TreePop();
             }
@@ -11,6 +11,9 @@
 
 #include "ecs/Component.h"
 #include "ecs/System.h"
+#include "ecs/Span.h"
+#include "Utils/TransformHierarchy.h"
+#include "Utils/TransformChanges.h"
 #include "cinder/Vector.h"
 
 
@@ -18,7 +21,36 @@
 #include "CinderImGui.h"
 
 
-class Transform : public ecs::Component, public std::enable_shared_from_this<Transform>{
+class Transform;
+struct TransformSystem;
+
+// walks a transform's children through their sibling links, no allocation. Don't reparent the current child while iterating
+class TransformChildIterator {
+    
+public:
+    explicit TransformChildIterator( Transform* iNode ) : mNode( iNode ) { }
+    
+    Transform* operator*() const { return mNode; }
+    TransformChildIterator& operator++();
+    
+    bool operator==( const TransformChildIterator& other ) const { return mNode == other.mNode; }
+    bool operator!=( const TransformChildIterator& other ) const { return mNode != other.mNode; }
+    
+private:
+    Transform* mNode;
+};
+
+struct TransformChildRange {
+    
+    TransformChildIterator begin() const { return TransformChildIterator( first ); }
+    TransformChildIterator end() const { return TransformChildIterator( nullptr ); }
+    bool empty() const { return first == nullptr; }
+    
+    Transform* first;
+};
+
+
+class Transform : public ecs::Component {
 
 public:
     Transform();
@@ -26,14 +58,33 @@ public:
     Transform( const Transform& other );
     ~Transform();
 
+    void setup() override;
+    
     void onDestroy() override {
         
-        // clean up children
-        if( children.size() > 0 ){
-            for( auto& c : children ){
-                c->removeParent(false, false);
+        markHierarchyDirty();
+        
+        if( mManager ){
+            TransformChanges::get( mManager )->remove( this );
+            if( mAlwaysUpdate ){
+                TransformHierarchy::get( mManager )->countAlwaysUpdate( false );
+                mAlwaysUpdate = false;
             }
         }
+        
+        if( parent ){
+            parent->removeChildFromList( this );
+        }
+        
+        // clean up children
+        for( auto c = mFirstChild; c != nullptr; ){
+            auto next = c->mNextSibling;
+            c->mNextSibling = c->mPrevSibling = nullptr;
+            c->removeParent(false, false);
+            c = next;
+        }
+        mFirstChild = mLastChild = nullptr;
+        mNumChildren = 0;
     }
     
     
@@ -42,13 +93,13 @@ public:
     ci::mat4 getCTransformMatrix() const { return mCTransform; }
     ci::mat4 getWorldTransform() {
         
-        if( needsUpdate() ){
-            updateMatrices();
-        }
-        
+        resolveWorldState();
         return mWorldTransform;
     }
     
+    // world transform blended between the previous and the current simulation step when the manager runs a fixed timestep, use it to draw
+    ci::mat4 getInterpolatedWorldTransform();
+    
     // Position ------------------------------
     ci::vec3 getWorldPos();
     void setWorldPos(const ci::vec3& pos);
@@ -56,18 +107,18 @@ public:
     ci::vec3 getPos()  {
         
         if(needsUpdate()){
-            updateMatrices(false);
+            updateMatrices();
         }
         return localPos;
         
     }
-    void setPos(const ci::vec3& pos){ localPos = pos; mNeedsUpdate = true; }
+    void setPos(const ci::vec3& pos){ localPos = pos; setNeedsUpdate(); }
     
     ci::vec3* getPosPtr(){  return &localPos; }
     
     // anchor point -----
     
-    void setAnchorPoint(const ci::vec3& p ){  anchorPoint = p; mNeedsUpdate = true; }
+    void setAnchorPoint(const ci::vec3& p ){  anchorPoint = p; setNeedsUpdate(); }
     ci::vec3 getAnchorPoint() const { return anchorPoint; }
     ci::vec3* getAnchorPointPtr() { return &anchorPoint; }
     
@@ -76,15 +127,15 @@ public:
     void setWorldScale(const ci::vec3& scale );
     ci::vec3 getWorldScale();
     
-    void setScale(const ci::vec3& scale ){ localScale = scale; mNeedsUpdate = true; }
-    void setScale( float s ) { setScale( ci::vec3(s,s,s) ); mNeedsUpdate = true; }
+    void setScale(const ci::vec3& scale ){ localScale = scale; setNeedsUpdate(); }
+    void setScale( float s ) { setScale( ci::vec3(s,s,s) ); setNeedsUpdate(); }
     
     ci::vec3* getScalePtr(){  return &localScale; }
     
     ci::vec3 getScale()  {
         
         if(needsUpdate()){
-            updateMatrices(false);
+            updateMatrices();
         }
         
         return localScale;
@@ -99,16 +150,16 @@ public:
 
     void setRotation( float radians ){
         mRotation = glm::angleAxis( radians, glm::vec3( 0, 0, 1 ) );
-        mNeedsUpdate = true;
+        setNeedsUpdate();
     }
     
-    void setRotation(const glm::quat& rotation ){ mRotation = rotation;  mNeedsUpdate = true; }
+    void setRotation(const glm::quat& rotation ){ mRotation = rotation;  setNeedsUpdate(); }
     
     
     glm::quat getRotation() {
         
         if(needsUpdate()){
-            updateMatrices(false);
+            updateMatrices();
         }
         
         return mRotation;
@@ -117,7 +168,7 @@ public:
     float getRotationRadians()  {
         
         if(needsUpdate()){
-            updateMatrices(false);
+            updateMatrices();
         }
         
         return glm::eulerAngles(mRotation).z;
@@ -127,6 +178,18 @@ public:
     
     float getWorldRotationRadians()  { return glm::eulerAngles( getWorldRotation() ).z; }
     
+    // Enabled / visible ----
+    
+    // a disabled transform and its whole subtree are skipped by matrix updates, the TransformSystem and picking
+    void setEnabled( bool enabled );
+    bool isEnabled() const { return mEnabled; }
+    bool isEnabledInHierarchy() const { return mEnabledInHierarchy; }
+    
+    // an invisible transform hides its whole subtree from drawing and picking, its matrices keep updating
+    void setVisible( bool visible );
+    bool isVisible() const { return mVisible; }
+    bool isVisibleInHierarchy() const { return mVisibleInHierarchy; }
+    
     // Parenting ----
     
     
@@ -135,24 +198,41 @@ public:
     
     Transform* getParent() const { return parent; }
     
-    std::vector<Transform*> getChildren() const { return children; }
+    // copies the children into a vector, prefer getChildrenRange() to iterate
+    std::vector<Transform*> getChildren() const;
+    TransformChildRange getChildrenRange() const { return TransformChildRange{ mFirstChild }; }
+    
+    Transform* getFirstChild() const { return mFirstChild; }
+    Transform* getNextSibling() const { return mNextSibling; }
+    size_t getNumChildren() const { return mNumChildren; }
     
     
     bool needsUpdate() {
         bool needs = (mNeedsUpdate || mAlwaysUpdate);
         return needs;
     }
+    
+    // flags the matrices as dirty and stamps the component as changed for change detection, the world state
+    // cached by the descendants is invalidated with it
+    void setNeedsUpdate(){
+        mNeedsUpdate = true;
+        markChanged();
+        invalidateDescendants();
+    }
 
     bool addChild( Transform* transform );
     bool removeChild( Transform* transform );
     
     // todo: rename to containChild
     bool hasChild(const Transform* child,  bool recursive = true );
+    
+    // true if `other` is somewhere below this transform, O(1) while the hierarchy numbering is up to date, O(depth) otherwise
+    bool isAncestorOf( const Transform* other ) const;
     bool hasParent() const { return (parent != nullptr); }
     
     Transform* getRoot();
     
-    bool isLeaf()const { return children.size() == 0 ? true : false; }
+    bool isLeaf()const { return mFirstChild == nullptr; }
     
     bool removeChildFromList(Transform* child);
     bool addChildToList(Transform* child);
@@ -166,40 +246,109 @@ public:
     size_t getId() const { return mId; }
     void setId(size_t i){ mId = i; }
 
-    void updateMatrices(bool emitSignal = true);
+    // recomputes the local and world matrices of this transform and its enabled descendants, and records each in the manager's TransformChanges
+    void updateMatrices();
     
-    void setAlwaysUpdate( bool v ){  mAlwaysUpdate = v; }
+    // the flag is counted per manager ( see TransformHierarchy::getNumAlwaysUpdate ) once the transform is added to one
+    void setAlwaysUpdate( bool v );
     bool getAlwaysUpdate(){ return mAlwaysUpdate; }
     
     
-    std::shared_ptr<  ci::signals::Signal< void(const Transform* handle ) > > getUpdateSignal(){ return onUpdateSignal; }
-    
 protected:
     
-    bool mNeedsUpdate = true;
-    bool mAlwaysUpdate = false;
+    void propagateHierarchyFlags();
+    void markHierarchyDirty();
+    
+    // recomputes the matrices of this transform only from its parent's current ones, recorded in `collected` when given, in `changes` otherwise
+    void updateNode( TransformChanges* changes, std::vector<Transform*>* collected );
+    // updateNode on this transform then on its enabled descendants, parents first
+    void updateSubtree( TransformChanges* changes, std::vector<Transform*>* collected );
+    
+    // local matrix from position, rotation, scale and anchor point
+    glm::mat4 computeLocalTransform() const;
+    
+    void storeWorldTransform( const glm::mat4& world );
+    void cacheWorldState();
+    
+    // world getters go through resolveWorldState, it recomputes from the ancestor whose edit made this node stale
+    void resolveWorldState(){
+        if( needsUpdate() || mParentChanged ){
+            updateFromEditedAncestor();
+        }
+    }
+    void updateFromEditedAncestor();
+    void updatePathFromAncestors();
+    void invalidateDescendants();
+    
+    friend class TransformHierarchy;
+    friend class TransformChildIterator;
+    friend class TransformReparentBatch;
+    friend class TransformChanges;
+    friend struct TransformSystem;
+    
+    // hot: everything updateNode and the traversals read or write, declared in that order so a node's update
+    // walks a few consecutive cache lines
     
-    std::shared_ptr< ci::signals::Signal< void(const Transform* handle ) > >  onUpdateSignal;
+    Transform* parent = nullptr;
+    Transform* mFirstChild = nullptr;
+    Transform* mNextSibling = nullptr;
     
     glm::vec3 localPos;
     glm::vec3 anchorPoint;
-    
-    glm::vec3 rotation;
     glm::vec3 localScale{1.0f, 1.0f, 1.0f};
-    
     glm::quat mRotation;
     
+    bool mNeedsUpdate = true;
+    bool mAlwaysUpdate = false;
+    
+    // an ancestor was edited since this node's world state was computed, set on the whole subtree at once
+    bool mParentChanged = false;
+    
+    // local flags and their combination with every ancestor, kept in sync when flags or parents change
+    bool mEnabled = true;
+    bool mVisible = true;
+    bool mEnabledInHierarchy = true;
+    bool mVisibleInHierarchy = true;
+    
+    bool mHasPrevWorldTransform = false;
+    
     glm::mat4 mCTransform;
     glm::mat4 mWorldTransform;
     
-    std::vector<Transform*> children;
-    Transform* parent = nullptr;
+    // world position, rotation and scale, cached with the world matrix so world queries don't walk the parents
+    glm::vec3 mWorldPos;
+    glm::quat mWorldRotation;
+    glm::vec3 mWorldScale{1.0f, 1.0f, 1.0f};
+    
+    // world transform as of the previous simulation step, double buffered for interpolation
+    std::uint64_t mWorldTransformStep = 0;
+    glm::mat4 mPrevWorldTransform;
+    
+    // position in the manager's TransformChanges, valid while the generation matches
+    std::uint64_t mChangeGeneration = 0;
+    std::size_t mChangeIndex = 0;
     
+    // cold: only touched when the hierarchy is edited or renumbered
+    
+    // intrusive child list, O(1) link and unlink without a per node container
+    Transform* mLastChild = nullptr;
+    Transform* mPrevSibling = nullptr;
+    size_t mNumChildren = 0;
+    
+    // depth first numbering, see TransformHierarchy
+    std::uint32_t mTourEnter = 0;
+    std::uint32_t mTourExit = 0;
+    std::uint64_t mTourVersion = 0;
     
     static size_t transformId;
     size_t mId = 0;
 };
 
+inline TransformChildIterator& TransformChildIterator::operator++(){
+    mNode = mNode->mNextSibling;
+    return *this;
+}
+
 
 
 template <>
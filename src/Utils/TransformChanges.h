@@ -0,0 +1,58 @@
+//
+//  TransformChanges.h
+//
+//  Transforms whose world matrix was recomputed this frame, stored as a
+//  manager resource. Listeners ( spatial indices, bounds caches, draw list
+//  keys ) read the list after the TransformSystem update instead of
+//  subscribing to every transform.
+//
+//  Every transform appears at most once per frame, even when several fixed
+//  steps ran. The TransformSystem clears the list at the start of each frame's
+//  simulation ( see System::beginFrame ). Transforms destroyed in between are
+//  left as nullptr entries.
+//
+
+#ifndef TransformChanges_h
+#define TransformChanges_h
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace ecs{
+    class Manager;
+}
+
+class Transform;
+
+class TransformChanges {
+
+public:
+
+    // the change list of `manager`, created the first time it's asked for
+    static TransformChanges* get( ecs::Manager* manager );
+
+    const std::vector<Transform*>& getChanged() const { return mChanged; }
+
+    std::size_t size() const { return mChanged.size(); }
+    bool empty() const { return mChanged.empty(); }
+
+    // O(1), a transform already in this frame's list is skipped
+    void add( Transform* transform );
+
+    // O(1), nulls the transform's entry if it has one
+    void remove( Transform* transform );
+
+    // starts a new frame, keeping the memory
+    void clear(){
+        mChanged.clear();
+        ++mGeneration;
+    }
+
+private:
+
+    std::uint64_t mGeneration{ 1 };
+    std::vector<Transform*> mChanged;
+};
+
+#endif /* TransformChanges_h */
@@ -0,0 +1,106 @@
+//
+//  TransformHierarchy.h
+//
+//  Depth first ( Euler tour ) numbering of every Transform of a Manager,
+//  stored as a manager resource. Each transform gets an enter index and the
+//  index of its last descendant, so "is A an ancestor of B" is two compares.
+//
+//  Reparenting only flags the numbering as stale, it is rebuilt once, by the
+//  TransformSystem or an explicit update(). Until then ancestor checks walk
+//  up the parents, O(depth), so bulk edits never pay a rebuild per edit.
+//
+
+#ifndef TransformHierarchy_h
+#define TransformHierarchy_h
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace ecs{
+    class Manager;
+}
+
+class Transform;
+
+class TransformHierarchy {
+
+public:
+
+    // the hierarchy of `manager`, created the first time it's asked for
+    static TransformHierarchy* get( ecs::Manager* manager );
+
+    void markDirty(){ mDirty = true; }
+    bool isDirty() const { return mDirty; }
+
+    // bumped by every rebuild, transforms numbered by an older one fall back to walking their parents
+    std::uint64_t getVersion() const { return mVersion; }
+
+    // rebuilds the numbering if anything changed since the last one
+    void update( ecs::Manager& manager );
+
+    // numbers `transforms` and their descendants, roots in the order given
+    void rebuild( const std::vector<Transform*>& transforms );
+
+    // every transform, parents before their children, valid while not dirty
+    const std::vector<Transform*>& getOrder() const { return mOrder; }
+
+    // live transforms of this manager flagged with setAlwaysUpdate, the TransformSystem polls every transform while it's non zero
+    std::size_t getNumAlwaysUpdate() const { return mNumAlwaysUpdate; }
+    void countAlwaysUpdate( bool added ){ added ? ++mNumAlwaysUpdate : --mNumAlwaysUpdate; }
+
+private:
+
+    bool mDirty{ true };
+    std::uint64_t mVersion{ 0 };
+
+    std::vector<Transform*> mOrder;
+
+    std::size_t mNumAlwaysUpdate{ 0 };
+};
+
+
+// Records reparent operations and applies them together: world transforms are
+// resolved once per node instead of walking the parent chain for every edit,
+// and the hierarchy numbering is rebuilt a single time at the end.
+//
+//  TransformReparentBatch batch( &manager );
+//  for( auto item : items ) batch.setParent( item, column );
+//  batch.apply(); // or let the batch go out of scope
+//
+// Operations run in the order they were recorded, the ones that would make a
+// cycle are skipped like Transform::addChild does.
+class TransformReparentBatch {
+    
+public:
+    
+    explicit TransformReparentBatch( ecs::Manager* manager ) : mManager( manager ) { }
+    ~TransformReparentBatch(){ apply(); }
+    
+    TransformReparentBatch( const TransformReparentBatch& ) = delete;
+    TransformReparentBatch& operator=( const TransformReparentBatch& ) = delete;
+    
+    void reserve( std::size_t n ){ mOps.reserve( n ); }
+    
+    // keeps the world transform by default, like Transform::setParent
+    void setParent( Transform* child, Transform* parent, bool keepWorldTransform = true ){ mOps.push_back( { child, parent, keepWorldTransform } ); }
+    void removeParent( Transform* child, bool keepWorldTransform = true ){ mOps.push_back( { child, nullptr, keepWorldTransform } ); }
+    
+    std::size_t size() const { return mOps.size(); }
+    
+    // applies every recorded operation and clears the batch
+    void apply();
+    
+private:
+    
+    struct Op {
+        Transform* child;
+        Transform* parent;
+        bool keepWorldTransform;
+    };
+    
+    ecs::Manager* mManager;
+    std::vector<Op> mOps;
+};
+
+#endif /* TransformHierarchy_h */
@@ -12,27 +12,61 @@
 #include "ecs/Manager.h"
 #include "Utils/Transform.h"
 
+#include <algorithm>
+
 struct TransformSystem : ecs::System{
     
+    // below this many transforms to recompute the update stays on the calling thread, 0 never goes parallel
+    void setMinParallelNodes( size_t n ){ mMinParallelNodes = n; }
+    size_t getMinParallelNodes() const { return mMinParallelNodes; }
+    
+    // listeners had the whole previous frame to read the last list, it then collects every step of this one
+    void beginFrame() override{
+        TransformChanges::get( getManager() )->clear();
+    }
+    
     void update() override{
         
-        auto& transforms = getManager()->getComponentsArray<Transform>();
-        for(auto& t : transforms){
+        // renumber the hierarchy once if it was edited since the last frame
+        auto hierarchy = TransformHierarchy::get( getManager() );
+        hierarchy->update( *getManager() );
+        
+        auto changes = TransformChanges::get( getManager() );
+        
+        mDirty.clear();
+        
+        // transforms flagged to always update need a full pass
+        if( hierarchy->getNumAlwaysUpdate() > 0 ){
+            
+            for(auto t : getManager()->getActiveComponentsSpan<Transform>()){
 
-            if(t->needsUpdate()){
-               t->updateMatrices();
+                if(t->needsUpdate() && t->isEnabledInHierarchy()){
+                    mDirty.push_back( t );
+                }
+            }
+        }else{
+            
+            // otherwise only visit the active transforms that changed since our last run
+            for( auto& t : getManager()->getActiveChangedComponents<Transform>( getLastRunTick() ) ){
+                
+                if(t->needsUpdate() && t->isEnabledInHierarchy()){
+                    mDirty.push_back( t );
+                }
             }
         }
+        
+        updateSubtrees( changes );
     }
     
     
     void draw() override {
         
         
-        auto transforms = getManager()->getComponentsArray<Transform>();
-
-        
-        for( auto& trans : transforms ){
+        for( auto trans : getManager()->getActiveComponentsSpan<Transform>() ){
+            
+            if( !trans->isVisibleInHierarchy() ){
+                continue;
+            }
 
             // draw parent child relation
             if( trans->hasParent() ){
@@ -69,7 +103,98 @@ struct TransformSystem : ecs::System{
         }
     }
     
+protected:
+    
+    // updates the dirty transforms, each subtree once, spread over the manager's worker pool when large enough
+    void updateSubtrees( TransformChanges* changes ){
+        
+        // an edited ancestor left out of mDirty ( its entity is inactive ) still has to be written before the
+        // transform below it, start from there so no update ever has to bring a parent up to date first
+        for( auto& t : mDirty ){
+            t = getEditedOrigin( t );
+        }
+        
+        // keep the dirty transforms no other dirty one contains, their update covers the rest
+        std::sort( mDirty.begin(), mDirty.end(), []( const Transform* a, const Transform* b ){ return a->mTourEnter < b->mTourEnter; } );
+        
+        mRoots.clear();
+        size_t numNodes = 0;
+        
+        for( auto t : mDirty ){
+            if( mRoots.empty() || t->mTourEnter > mRoots.back()->mTourExit ){
+                mRoots.push_back( t );
+                numNodes += subtreeSize( t );
+            }
+        }
+        
+        if( mMinParallelNodes == 0 || numNodes < mMinParallelNodes ){
+            for( auto t : mRoots ){
+                t->updateSubtree( changes, nullptr );
+            }
+            return;
+        }
+        
+        auto& pool = getManager()->getWorkerPool();
+        auto numSlots = pool.getNumThreads() + 1;
+        auto maxItemNodes = std::max<size_t>( numNodes / ( numSlots * 4 ), 1 );
+        
+        // a subtree too big to balance is split: its root is updated here and its children handed out instead,
+        // so every parent is still written before its children read it
+        mItems.clear();
+        while( !mRoots.empty() ){
+            
+            auto t = mRoots.back();
+            mRoots.pop_back();
+            
+            if( subtreeSize( t ) > maxItemNodes && !t->isLeaf() ){
+                
+                t->updateNode( changes, nullptr );
+                for( auto c : t->getChildrenRange() ){
+                    if( c->mEnabled ){
+                        mRoots.push_back( c );
+                    }
+                }
+            }else{
+                mItems.push_back( t );
+            }
+        }
+        
+        // biggest first, the small ones fill the gaps at the end
+        std::sort( mItems.begin(), mItems.end(), []( const Transform* a, const Transform* b ){ return subtreeSize( a ) > subtreeSize( b ); } );
+        
+        mCollected.resize( numSlots );
+        for( auto& c : mCollected ){
+            c.clear();
+        }
+        
+        pool.parallelFor( mItems.size(), [this]( size_t index, size_t slot ){
+            mItems[index]->updateSubtree( nullptr, &mCollected[slot] );
+        } );
+        
+        for( auto& collected : mCollected ){
+            for( auto t : collected ){
+                changes->add( t );
+            }
+        }
+    }
+    
+    static size_t subtreeSize( const Transform* t ){ return t->mTourExit - t->mTourEnter + 1; }
+    
+    // the outermost ancestor whose edit reaches `t`, `t` itself when its parent is current
+    static Transform* getEditedOrigin( Transform* t ){
+        
+        while( t->parent && ( t->mParentChanged || t->parent->mNeedsUpdate || t->parent->mParentChanged ) ){
+            t = t->parent;
+        }
+        return t;
+    }
+    
+    size_t mMinParallelNodes = 4096;
     
+    std::vector<Transform*> mDirty;
+    std::vector<Transform*> mRoots;
+    std::vector<Transform*> mItems;
+    std::vector< std::vector<Transform*> > mCollected;
 };
 
 
@@ -0,0 +1,110 @@
+//
+//  BatchAllocator.h
+//
+//  Lets Manager::createEntities carve the entities, their components and the
+//  component factory helpers of a whole batch out of one block instead of a
+//  malloc each. Everything is still handed out as a regular shared_ptr through
+//  std::allocate_shared, every control block keeps a reference to the block and
+//  the block is freed once the last object of the batch is gone.
+//
+//  Memory freed inside a block is not reused: a single surviving entity keeps
+//  its whole batch allocated. Batches suit entities that live and die together
+//  ( a level, a grid, the initial population ), not ones destroyed one at a
+//  time and created again, those would pin a block per batch they came from.
+//
+
+#ifndef LEKSAPP_BATCH_ALLOCATOR_H
+#define LEKSAPP_BATCH_ALLOCATOR_H
+
+#include <memory>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+namespace ecs{
+
+    class BatchBlock {
+
+    public:
+
+        explicit BatchBlock( std::size_t bytes ) : mMemory( new char[bytes] ), mSize( bytes ) { }
+
+        BatchBlock( const BatchBlock& ) = delete;
+        BatchBlock& operator=( const BatchBlock& ) = delete;
+
+        // nullptr once the block is full, or for types aligned beyond what new[] guarantees
+        void* allocate( std::size_t bytes, std::size_t alignment ){
+
+            if( alignment > alignof( std::max_align_t ) ){
+                return nullptr;
+            }
+
+            auto base = reinterpret_cast<std::uintptr_t>( mMemory.get() );
+            auto offset = ( ( base + mUsed + alignment - 1 ) & ~( alignment - 1 ) ) - base;
+
+            if( offset + bytes > mSize ){
+                return nullptr;
+            }
+
+            mUsed = offset + bytes;
+            return mMemory.get() + offset;
+        }
+
+        bool owns( const void* p ) const {
+            auto c = static_cast<const char*>( p );
+            return c >= mMemory.get() && c < mMemory.get() + mSize;
+        }
+
+        std::size_t getBytesUsed() const { return mUsed; }
+        std::size_t getCapacity() const { return mSize; }
+
+    private:
+
+        std::unique_ptr<char[]> mMemory;
+        std::size_t mSize;
+        std::size_t mUsed{ 0 };
+    };
+
+
+    // std allocator over a BatchBlock, falls back to the heap when the block runs out
+    template<typename T>
+    struct BatchAllocator {
+
+        using value_type = T;
+
+        explicit BatchAllocator( const std::shared_ptr<BatchBlock>& block ) : mBlock( block ) { }
+
+        template<typename U>
+        BatchAllocator( const BatchAllocator<U>& other ) : mBlock( other.mBlock ) { }
+
+        T* allocate( std::size_t n ){
+
+            void* p = mBlock->allocate( n * sizeof( T ), alignof( T ) );
+            return static_cast<T*>( p ? p : ::operator new( n * sizeof( T ) ) );
+        }
+
+        // memory from the block is only given back with the whole block
+        void deallocate( T* p, std::size_t ){
+
+            if( !mBlock->owns( p ) ){
+                ::operator delete( p );
+            }
+        }
+
+        // room allocate_shared needs for one T: the object, its control block and the allocator copy it keeps
+        static constexpr std::size_t getSharedBytes(){
+            return sizeof( T ) + sizeof( BatchAllocator<T> ) + 4 * sizeof( void* ) + alignof( std::max_align_t );
+        }
+
+        std::shared_ptr<BatchBlock> mBlock;
+    };
+
+    template<typename T, typename U>
+    bool operator==( const BatchAllocator<T>& a, const BatchAllocator<U>& b ){ return a.mBlock == b.mBlock; }
+
+    template<typename T, typename U>
+    bool operator!=( const BatchAllocator<T>& a, const BatchAllocator<U>& b ){ return a.mBlock != b.mBlock; }
+
+}
+
+#endif //LEKSAPP_BATCH_ALLOCATOR_H
@@ -3,7 +3,12 @@
 //
 
 #include <memory>
-#include <bitset>
+#include <cassert>
+#include <type_traits>
+#include <typeinfo>
+#include <cstdint>
+
+#include "Signature.h"
 
 #ifndef ECSSAPP_COMPONENT_H
 #define ECSSAPP_COMPONENT_H
@@ -21,14 +26,30 @@ namespace ecs{
     using ComponentID = std::size_t;
     using ComponentRef = std::shared_ptr<Component>;
 
-    constexpr std::size_t MaxComponents{120};
-    using ComponentBitset = std::bitset<MaxComponents>;
+    // number of component types a manager can hold, define ECS_MAX_COMPONENTS before including the ecs to change it ( multiple of 64 )
+#ifndef ECS_MAX_COMPONENTS
+    #define ECS_MAX_COMPONENTS 256
+#endif
+
+    constexpr std::size_t MaxComponents{ ECS_MAX_COMPONENTS };
+    using ComponentBitset = Signature<MaxComponents>;
     
     namespace internal{
 
         //@TODO: maybe move this to std:: typeinfo?
-        static ComponentID lastID{0};
+        // the counter lives in an inline function so every translation unit shares it
+        inline ComponentID& getLastComponentID() noexcept {
+            static ComponentID lastID{0};
+            return lastID;
+        }
+        
+        inline ComponentID getNumComponentTypes() noexcept {
+            return getLastComponentID();
+        }
+        
         inline ComponentID getUniqueComponentID() noexcept {
+            auto& lastID = getLastComponentID();
+            assert( lastID < MaxComponents && "too many component types, raise ECS_MAX_COMPONENTS" );
             return lastID++;
         }
     
@@ -38,6 +59,11 @@ namespace ecs{
             virtual void save(void* archiver){};
             virtual ComponentRef create() = 0;
             
+            // used by the manager stats
+            virtual std::size_t getComponentSize() const { return 0; }
+            virtual std::size_t getFactorySize() const { return sizeof( *this ); }
+            virtual const char* getTypeName() const { return ""; }
+            
             ComponentID _id;
         };
         
@@ -60,6 +86,13 @@ namespace ecs{
     public:
         virtual void setup() { };
         virtual void onDestroy(){  };
+        
+        // stamps this component with the manager's current change tick, call it after writing to the component
+        void markChanged();
+        
+        // tick of the last markChanged call ( or of when the component was added )
+        std::uint64_t getChangedTick() const { return mChangedTick; }
+        bool hasChangedSince( std::uint64_t tick ) const { return mChangedTick > tick; }
 
 
         std::weak_ptr<Entity> getEntity(){ return mEntity; }
@@ -74,9 +107,10 @@ namespace ecs{
         std::shared_ptr<internal::ComponentFactoryInterface> mFactory;
         
         std::weak_ptr<Entity> mEntity;
-        Manager* mManager;
+        Manager* mManager{ nullptr };
     
-        std::size_t mComponentId;
+        std::size_t mComponentId{ 0 };
+        std::uint64_t mChangedTick{ 0 };
 
         friend class Entity;
         friend class Manager;
@@ -96,6 +130,11 @@ namespace ecs{
     };
     
     
+    // empty types that don't derive from Component are tags: they live only in the entity signature
+    template<typename T>
+    struct is_tag_component : std::integral_constant< bool, std::is_empty<T>::value && !std::is_base_of<ecs::Component, T>::value > { };
+    
+    
     template <class T,
     typename std::enable_if< !std::is_base_of<ecs::Component, T>::value, T>::type* = nullptr>
     inline ComponentID getComponentTypeID(){
@@ -124,6 +163,10 @@ namespace ecs{
             
         
         ComponentRef create() override;
+        
+        std::size_t getComponentSize() const override { return sizeof( T ); }
+        std::size_t getFactorySize() const override { return sizeof( ComponentFactory<T> ); }
+        const char* getTypeName() const override { return typeid( T ).name(); }
             
             
         void save(void* archiver) override{ }
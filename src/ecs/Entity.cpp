@@ -11,24 +11,134 @@ using namespace ecs;
 
 unsigned int Entity::mNumOfEntities = 0;
 
+namespace {
+    
+    // entities and components can double as drawables, keep their draw target in sync with the entity
+    template<typename T>
+    void activateDrawable( T* object, bool active ){
+        
+        auto drawable = dynamic_cast<IDrawable*>( object );
+        if( drawable ){
+            drawable->setDrawableActive( active );
+        }
+    }
+}
+
 void Entity::addComponentToManager( ComponentID cId, const ComponentRef& component){
 
     mManager->addComponent( cId, component );
 
-    mComponentArray[cId] = component.get();
-    mComponentBitset[cId] = true;
+    mStorage->setComponent( cId, mIndex, component.get() );
 
     component->mEntity = shared_from_this();
     component->mManager = mManager;
     component->mComponentId = cId;
+    component->markChanged();
     component->setup();
+    
+    if( !mIsActive ){
+        mManager->markActivityChanged( cId );
+        activateDrawable( component.get(), false );
+    }
+
+    mManager->notifyComponentAdded( cId, component->mEntity );
+}
+
+void Entity::removeComponentFromManager( ComponentID cId ){
+    
+    mManager->notifyComponentRemoved( cId, shared_from_this() );
+    
+    mStorage->getComponent( cId, mIndex )->mEntity = std::weak_ptr<Entity>();
+    mStorage->setComponent( cId, mIndex, nullptr );
+    
+    ECS_PROFILE_EXPR( mManager->mProfiler.addStructuralChange() );
+    markRefresh();
+}
+
+void Entity::addTagToManager( ComponentID cId ){
+    
+    if( mStorage->getSignature( mIndex )[cId] ){
+        return;
+    }
+    
+    mStorage->setTag( cId, mIndex, true );
+    mManager->notifyComponentAdded( cId, shared_from_this() );
+    ECS_PROFILE_EXPR( mManager->mProfiler.addStructuralChange() );
+}
+
+void Entity::removeTagFromManager( ComponentID cId ){
+    
+    mStorage->setTag( cId, mIndex, false );
+    mManager->notifyComponentRemoved( cId, shared_from_this() );
+    ECS_PROFILE_EXPR( mManager->mProfiler.addStructuralChange() );
+}
 
+Span<Component*> Entity::getComponentsSpan(){
+    
+    if( !isRegistered() ){
+        return Span<Component*>();
+    }
+    
+    const auto& signature = mStorage->getSignature( mIndex );
+    
+    Component** components = mManager->getFrameArena().allocate<Component*>( signature.count() );
+    std::size_t count = 0;
+    for( std::size_t i = 0; i < internal::getNumComponentTypes(); i++ ){
+        
+        auto component = signature[i] ? mStorage->getComponent( i, mIndex ) : nullptr;
+        if( component ){
+            components[count++] = component;
+        }
+    }
+    
+    return Span<Component*>( components, count );
+}
+
+void Entity::setActive( bool active ){
+    
+    if( active == mIsActive ){
+        return;
+    }
+    
+    mIsActive = active;
+    
+    if( !isRegistered() ){
+        return;
+    }
+    
+    mStorage->setActive( mIndex, active );
+    
+    const auto& signature = mStorage->getSignature( mIndex );
+    mManager->markActivityChanged( signature );
+    
+    // drawables of inactive entities are moved aside in their draw target. Changes made while inactive were
+    // skipped by the active change queries, a reactivated entity reports all its components as changed
+    activateDrawable( this, active );
+    for( std::size_t i = 0; i < internal::getNumComponentTypes(); i++ ){
+        if( signature[i] ){
+            auto component = mStorage->getComponent( i, mIndex );
+            activateDrawable( component, active );
+            if( active && component ){
+                component->markChanged();
+            }
+        }
+    }
 }
 
 void Entity::markRefresh(){
     mManager->needsRefresh = true;
 }
 
+void Component::markChanged(){
+    
+    if( mManager == nullptr ){
+        return;
+    }
+    
+    mChangedTick = mManager->getTick();
+    mManager->mTypeChangedTicks[mComponentId].store( mChangedTick, std::memory_order_relaxed );
+}
+
 
 
 
@@ -6,10 +6,12 @@
 #define LEKSAPP_ENTITY_H
 
 
-#include <bitset>
 #include <array>
 #include <vector>
+#include <cstdint>
 #include "Component.h"
+#include "EntityStorage.h"
+#include "Span.h"
 
 namespace ecs{
 
@@ -26,7 +28,6 @@ namespace ecs{
         Entity( ) {
             mEntityId = mNumOfEntities;
             mNumOfEntities += 1;
-            mComponentArray.fill(nullptr);
         }
 
         virtual ~Entity(){
@@ -47,12 +48,12 @@ namespace ecs{
         
         template < typename T>
         bool hasComponent() const{
-            return mComponentBitset[ getComponentTypeID<T>() ];
+            return isRegistered() && mStorage->getSignature( mIndex )[ getComponentTypeID<T>() ];
         }
 
         
         template <class T,
-        typename std::enable_if< !std::is_base_of<ecs::Component, T>::value, T>::type* = nullptr>
+        typename std::enable_if< !std::is_base_of<ecs::Component, T>::value && !is_tag_component<T>::value, T>::type* = nullptr>
         T* addComponent() {
             std::shared_ptr<WrapperComponent<T>> rawComponent( new WrapperComponent<T>( T() ) );
             
@@ -89,7 +90,7 @@ namespace ecs{
         
         
         template <class T, typename... TArgs,
-        typename std::enable_if< ! std::is_base_of<ecs::Component, T>::value, T>::type* = nullptr>
+        typename std::enable_if< !std::is_base_of<ecs::Component, T>::value && !is_tag_component<T>::value, T>::type* = nullptr>
         T* addComponent(TArgs&&... _Args) {
             
             std::shared_ptr<WrapperComponent<T>> rawComponent( new WrapperComponent<T>( T(std::forward<TArgs>(_Args)... )) );
@@ -120,6 +121,15 @@ namespace ecs{
             return  rawComponent.get();
             
         }
+        
+        // tags are empty types, they only flip a bit in the entity signature and never allocate
+        template <class T,
+        typename std::enable_if< is_tag_component<T>::value, T>::type* = nullptr>
+        T* addComponent() {
+            
+            addTagToManager( getComponentTypeID<T>() );
+            return getComponent<T>();
+        }
      
         void addComponent( ComponentRef& rawComponent ){
             addComponentToManager(rawComponent->getFactory()->_id, rawComponent);
@@ -132,75 +142,113 @@ namespace ecs{
 
             componentTypeID = getComponentTypeID<T>();  // we dont need a specialized function for wrapper components because getComponentTypeID already does that
     
-            mComponentBitset.set(componentTypeID, 0);
-            mComponentArray [ componentTypeID ]->mEntity = std::weak_ptr<Entity>();/**/
-            mComponentArray [ componentTypeID ] = nullptr;
-
-            markRefresh();
+            if( !hasComponent<T>() ){
+                return;
+            }
+            
+            if( is_tag_component<T>::value ){
+                removeTagFromManager( componentTypeID );
+            }else{
+                removeComponentFromManager( componentTypeID );
+            }
         }
 
         
         template <class T,
-        typename std::enable_if< !std::is_base_of<ecs::Component, T>::value, T>::type* = nullptr>
+        typename std::enable_if< !std::is_base_of<ecs::Component, T>::value && !is_tag_component<T>::value, T>::type* = nullptr>
         T* getComponent(){
             
             assert(hasComponent< WrapperComponent<T> >());
-            Component* comp = mComponentArray[getComponentTypeID< WrapperComponent<T> >()];
+            Component* comp = mStorage->getComponent( getComponentTypeID< WrapperComponent<T> >(), mIndex );
             WrapperComponent<T>* wrapper = static_cast< WrapperComponent<T>* >(  comp );
             
             return & (wrapper->object);
         }
         
         
+        // tags have no storage, every entity shares the same empty instance
+        template <class T,
+        typename std::enable_if< is_tag_component<T>::value, T>::type* = nullptr>
+        T* getComponent(){
+            
+            assert(hasComponent<T>());
+            static T tag;
+            return &tag;
+        }
+        
+        
         template <class T,
         typename std::enable_if< std::is_base_of<ecs::Component, T>::value, T>::type* = nullptr>
         T* getComponent(){
             
             assert(hasComponent<T>());
-            return (T*)mComponentArray[getComponentTypeID<T>()];
+            return (T*)mStorage->getComponent( getComponentTypeID<T>(), mIndex );
             
         }
         
-        inline std::bitset<MaxComponents> getComponentBitset(){ return mComponentBitset; }
+        inline ComponentBitset getComponentBitset() const {
+            return isRegistered() ? mStorage->getSignature( mIndex ) : ComponentBitset();
+        }
         std::shared_ptr<internal::EntityInfoBase> mInfo;
         
         inline std::vector< Component* > getComponents(){
             std::vector< Component* > components;
             
-            for( int i = 0; i < internal::lastID; i++ ){
+            if( !isRegistered() ){
+                return components;
+            }
             
-                components.push_back( mComponentArray[i] );
+            const auto& signature = mStorage->getSignature( mIndex );
+            for( std::size_t i = 0; i < internal::getNumComponentTypes(); i++ ){
+            
+                auto component = signature[i] ? mStorage->getComponent( i, mIndex ) : nullptr;
+                if( component ){ // tags have no component object
+                    components.push_back( component );
+                }
             }
             
             return components;
         }
         
+        // same as getComponents, allocated from the manager's frame arena
+        Span<Component*> getComponentsSpan();
+        
+        // index of this entity's record in the manager storage, only valid while the entity is registered
+        std::uint32_t getIndex() const { return mIndex; }
+        std::uint32_t getGeneration() const { return mGeneration; }
+        
         Manager* getManager() { return mManager; }
         
         
-        void setActive( bool active = true ){
-            mIsActive = active;
-        }
+        // inactive entities are partitioned out of the active component arrays and queries, and their drawables are skipped
+        void setActive( bool active = true );
         
         bool isActive() const { return mIsActive; }
         
     protected:
         
         void addComponentToManager( ComponentID cId,  const ComponentRef& component );
+        void removeComponentFromManager( ComponentID cId );
+        void addTagToManager( ComponentID cId );
+        void removeTagFromManager( ComponentID cId );
         void markRefresh();
         
+        bool isRegistered() const { return mStorage != nullptr && mStorage->isValid( mIndex, mGeneration ); }
+        
         friend class Manager;
         
         
-        Manager* mManager;
-        bool mIsAlive{ true };
-        bool mIsActive{ true };
+        Manager* mManager{ nullptr };
+        EntityStorage* mStorage{ nullptr };
         
-        std::bitset<MaxComponents> mComponentBitset;
-        std::array< Component* , MaxComponents> mComponentArray;
+        std::uint32_t mIndex{ 0 };
+        std::uint32_t mGeneration{ 0 };
         
         static unsigned int mNumOfEntities;
         unsigned int mEntityId;
+        
+        bool mIsAlive{ true };
+        bool mIsActive{ true };
     };
 
     template<class T>
@@ -0,0 +1,159 @@
+//
+//  EntityStorage.h
+//
+//  Compact per-entity records ( signature + generation ) and the per-type
+//  component lookup tables, owned by the Manager. Signatures and generations
+//  are kept in separate packed arrays so queries can scan the signatures alone.
+//
+
+#ifndef LEKSAPP_ENTITY_STORAGE_H
+#define LEKSAPP_ENTITY_STORAGE_H
+
+#include <array>
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+
+#include "Component.h"
+
+namespace ecs{
+
+    class EntityStorage {
+
+    public:
+
+        // returns a free record index, recycling released slots first
+        std::uint32_t allocate(){
+
+            if( ! mFreeIndices.empty() ){
+                auto index = mFreeIndices.back();
+                mFreeIndices.pop_back();
+                return index;
+            }
+
+            mSignatures.emplace_back();
+            mGenerations.push_back( 0 );
+            mActive.push_back( 1 );
+            return static_cast<std::uint32_t>( mSignatures.size() - 1 );
+        }
+
+        // `count` free record indices written to `indices`, recycled slots first, the rest appended in one resize
+        void allocate( std::size_t count, std::uint32_t* indices ){
+
+            std::size_t recycled = std::min( count, mFreeIndices.size() );
+            for( std::size_t i = 0; i < recycled; ++i ){
+                indices[i] = mFreeIndices.back();
+                mFreeIndices.pop_back();
+            }
+
+            auto first = mSignatures.size();
+            auto appended = count - recycled;
+            mSignatures.resize( first + appended );
+            mGenerations.resize( first + appended, 0 );
+            mActive.resize( first + appended, 1 );
+
+            for( std::size_t i = 0; i < appended; ++i ){
+                indices[recycled + i] = static_cast<std::uint32_t>( first + i );
+            }
+        }
+
+        // clears the record and bumps its generation so stale entity handles stop resolving
+        void release( std::uint32_t index ){
+
+            auto& signature = mSignatures[index];
+
+            for( std::size_t i = 0; i < MaxComponents; ++i ){
+                if( signature[i] && index < mLookup[i].size() ){
+                    mLookup[i][index] = nullptr;
+                }
+            }
+
+            signature.reset();
+            mGenerations[index] += 1;
+            mActive[index] = 1;
+
+            mFreeIndices.push_back( index );
+        }
+
+        void reserve( std::size_t count ){
+            mSignatures.reserve( mSignatures.size() + count );
+            mGenerations.reserve( mGenerations.size() + count );
+            mActive.reserve( mActive.size() + count );
+        }
+
+        bool isValid( std::uint32_t index, std::uint32_t generation ) const {
+            return index < mGenerations.size() && mGenerations[index] == generation;
+        }
+
+        const ComponentBitset& getSignature( std::uint32_t index ) const { return mSignatures[index]; }
+        std::uint32_t getGeneration( std::uint32_t index ) const { return mGenerations[index]; }
+        
+        // inactive records are skipped by the active queries
+        bool isActive( std::uint32_t index ) const { return mActive[index] != 0; }
+        void setActive( std::uint32_t index, bool active ){ mActive[index] = active ? 1 : 0; }
+
+        // packed signature array, indexed by record index
+        const std::vector<ComponentBitset>& getSignatures() const { return mSignatures; }
+
+        Component* getComponent( ComponentID id, std::uint32_t index ) const {
+
+            const auto& lookup = mLookup[id];
+            return index < lookup.size() ? lookup[index] : nullptr;
+        }
+
+        void setComponent( ComponentID id, std::uint32_t index, Component* component ){
+
+            auto& lookup = mLookup[id];
+            if( lookup.size() <= index ){
+                lookup.resize( mSignatures.size(), nullptr );
+            }
+
+            lookup[index] = component;
+            mSignatures[index].set( id, component != nullptr );
+        }
+
+        // grows the lookup table of `id` to cover every record, so a batch of setComponent calls doesn't resize it
+        void reserveLookup( ComponentID id ){
+
+            auto& lookup = mLookup[id];
+            if( lookup.size() < mSignatures.size() ){
+                lookup.resize( mSignatures.size(), nullptr );
+            }
+        }
+
+        // tags only live in the signature, there is nothing to look up
+        void setTag( ComponentID id, std::uint32_t index, bool value ){
+            mSignatures[index].set( id, value );
+        }
+
+        // bytes reserved by the records, the free list and the lookup tables
+        std::size_t getMemoryUsage() const {
+            
+            std::size_t bytes = mSignatures.capacity() * sizeof( ComponentBitset )
+                              + mGenerations.capacity() * sizeof( std::uint32_t )
+                              + mActive.capacity() * sizeof( std::uint8_t )
+                              + mFreeIndices.capacity() * sizeof( std::uint32_t );
+            
+            for( auto& lookup : mLookup ){
+                bytes += lookup.capacity() * sizeof( Component* );
+            }
+            return bytes;
+        }
+
+        std::size_t size() const { return mSignatures.size(); }
+        std::size_t getNumFree() const { return mFreeIndices.size(); }
+
+    protected:
+
+        std::vector<ComponentBitset> mSignatures;
+        std::vector<std::uint32_t> mGenerations;
+        std::vector<std::uint8_t> mActive;
+        std::vector<std::uint32_t> mFreeIndices;
+
+        // sparse per type tables, indexed by record index
+        std::array< std::vector<Component*>, MaxComponents > mLookup;
+    };
+
+}
+
+#endif //LEKSAPP_ENTITY_STORAGE_H
@@ -0,0 +1,148 @@
+//
+//  FrameArena.h
+//
+//  Linear allocator for per-frame scratch memory. Allocations are a pointer
+//  bump, nothing is freed individually: the Manager resets the whole arena
+//  once per frame. When a frame overflows the first block the arena grows
+//  into extra blocks and, on the next reset, merges them into a single block
+//  big enough for the whole frame, so a steady state frame never mallocs.
+//
+//  Only trivially destructible data should live in the arena, destructors
+//  are never called.
+//
+
+#ifndef LEKSAPP_FRAME_ARENA_H
+#define LEKSAPP_FRAME_ARENA_H
+
+#include <vector>
+#include <memory>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#include "Span.h"
+
+namespace ecs{
+
+    class FrameArena {
+
+    public:
+
+        explicit FrameArena( std::size_t iBlockSize = 64 * 1024 ) : mBlockSize( iBlockSize ) { }
+
+        FrameArena( const FrameArena& ) = delete;
+        FrameArena& operator=( const FrameArena& ) = delete;
+
+        void* allocate( std::size_t bytes, std::size_t alignment = alignof( std::max_align_t ) ){
+
+            if( mBlocks.empty() ){
+                addBlock( bytes + alignment );
+            }
+
+            void* ptr = alignedOffset( mBlocks.back(), bytes, alignment );
+            if( ptr == nullptr ){
+                addBlock( bytes + alignment );
+                ptr = alignedOffset( mBlocks.back(), bytes, alignment );
+            }
+
+            mBytesUsed += bytes;
+            return ptr;
+        }
+
+        template<typename T>
+        T* allocate( std::size_t count ){
+
+            static_assert( std::is_trivially_destructible<T>::value, "frame arena memory is never destructed" );
+            return static_cast<T*>( allocate( sizeof( T ) * count, alignof( T ) ) );
+        }
+
+        // copies [first, last) into the arena
+        template<typename T, typename Iterator>
+        Span<T> copy( Iterator first, Iterator last, std::size_t count ){
+
+            T* data = allocate<T>( count );
+            std::size_t i = 0;
+            for( auto it = first; it != last; ++it ){
+                data[i++] = *it;
+            }
+            return Span<T>( data, i );
+        }
+
+        // rewinds the arena, blocks added during the frame are merged into one
+        void reset(){
+
+            if( mBlocks.size() > 1 ){
+
+                std::size_t total = 0;
+                for( auto& b : mBlocks ){
+                    total += b.capacity;
+                }
+
+                mBlocks.clear();
+                addBlock( total );
+            }
+
+            for( auto& b : mBlocks ){
+                b.offset = 0;
+            }
+
+            mPeakBytes = mBytesUsed > mPeakBytes ? mBytesUsed : mPeakBytes;
+            mBytesUsed = 0;
+        }
+
+        std::size_t getBytesUsed() const { return mBytesUsed; }
+        std::size_t getPeakBytes() const { return mPeakBytes; }
+        std::size_t getNumBlocks() const { return mBlocks.size(); }
+        std::size_t getNumBlockAllocations() const { return mNumBlockAllocations; }
+
+        std::size_t getCapacity() const {
+            std::size_t total = 0;
+            for( auto& b : mBlocks ){
+                total += b.capacity;
+            }
+            return total;
+        }
+
+    private:
+
+        struct Block {
+            std::unique_ptr<unsigned char[]> memory;
+            std::size_t capacity{ 0 };
+            std::size_t offset{ 0 };
+        };
+
+        static void* alignedOffset( Block& block, std::size_t bytes, std::size_t alignment ){
+
+            auto base = reinterpret_cast<std::uintptr_t>( block.memory.get() );
+            auto current = base + block.offset;
+            auto aligned = ( current + alignment - 1 ) & ~( std::uintptr_t( alignment ) - 1 );
+
+            if( aligned + bytes > base + block.capacity ){
+                return nullptr;
+            }
+
+            block.offset = ( aligned - base ) + bytes;
+            return reinterpret_cast<void*>( aligned );
+        }
+
+        void addBlock( std::size_t minSize ){
+
+            Block block;
+            block.capacity = minSize > mBlockSize ? minSize : mBlockSize;
+            block.memory.reset( new unsigned char[ block.capacity ] );
+
+            mBlocks.push_back( std::move( block ) );
+            mNumBlockAllocations++;
+        }
+
+        std::size_t mBlockSize;
+        std::vector<Block> mBlocks;
+
+        std::size_t mBytesUsed{ 0 };
+        std::size_t mPeakBytes{ 0 };
+        std::size_t mNumBlockAllocations{ 0 };
+    };
+
+}
+
+#endif //LEKSAPP_FRAME_ARENA_H
@@ -8,9 +8,26 @@
 
 #include "Entity.h"
 #include "System.h"
+#include "Observer.h"
+#include "Resource.h"
+#include "FrameArena.h"
+#include "Stats.h"
+#include "Profiler.h"
+#include "RenderPacket.h"
+#include "ThreadPool.h"
+#include "BatchAllocator.h"
 
 #include <vector>
 #include <array>
+#include <map>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
 
 #include "Utils/DrawSystem.h"
 
@@ -24,10 +41,22 @@ class Manager {
 public:
     Manager(){
         mDrawSystem = DrawSystem::getInstance();
+        
+        for( auto& t : mTypeChangedTicks ){
+            t.store( 0 );
+        }
+        
+        mStartTime = std::chrono::steady_clock::now();
+        setResource<FrameTime>();
     }
     
     ~Manager(){
-
+        
+        // a destructor can't rethrow what the last background step threw, it only waits for it
+        try{
+            waitForSimulation();
+        }catch( ... ){
+        }
     }
 
 
@@ -39,7 +68,7 @@ public:
     EntityRef createEntity(){
         
         EntityRef e = std::make_shared<Entity>();
-        e->mManager = this;
+        registerEntity( e.get() );
         
         mEntities.emplace_back(e);
         e->setup();
@@ -52,7 +81,7 @@ public:
     std::shared_ptr<T> createEntity(Args&&... args){
 
         std::shared_ptr<T> e = std::make_shared<T>( std::forward<Args>(args)...  );
-        e->mManager = this;
+        registerEntity( e.get() );
         e->mInfo = std::make_shared< EntityHelper<T> >();
         mEntities.emplace_back(e);
         e->setup();
@@ -60,6 +89,85 @@ public:
         return e;
     }
 
+    // creates `count` entities that share the same component signature. The entities, their components and the component
+    // factories come out of one memory block, the records are allocated in one pass and every component type is added to
+    // the whole batch at once: components are set up type by type, not entity by entity. The block is only freed once
+    // every entity of the batch is gone ( see BatchAllocator.h ), use createEntity for short lived entities that die
+    // at different times
+    template<typename... Components>
+    std::vector<EntityRef> createEntities( std::size_t count ){
+        
+        std::vector<EntityRef> entities;
+        if( count == 0 ){
+            return entities;
+        }
+        entities.reserve( count );
+        
+        std::size_t bytesPerEntity = BatchAllocator<Entity>::getSharedBytes();
+        int sizeExpansion[] = { 0, ( bytesPerEntity += getBatchBytes<Components>(), 0 )... };
+        (void)sizeExpansion;
+        auto block = std::make_shared<BatchBlock>( count * bytesPerEntity );
+        
+        std::vector<std::uint32_t> indices( count );
+        mStorage.allocate( count, indices.data() );
+        
+        mEntities.reserve( mEntities.size() + count );
+        for( std::size_t i = 0; i < count; ++i ){
+            
+            EntityRef e = std::allocate_shared<Entity>( BatchAllocator<Entity>( block ) );
+            registerEntity( e.get(), indices[i] );
+            
+            mEntities.push_back( e );
+            entities.push_back( e );
+        }
+        
+        for( auto& e : entities ){
+            e->setup();
+        }
+        
+        int addExpansion[] = { 0, ( addComponents<Components>( entities, block ), 0 )... };
+        (void)addExpansion;
+        
+        return entities;
+    }
+    
+    // marks every entity in [first, last) as dead and compacts the storage in a single refresh
+    template<typename Iterator>
+    void destroyEntities( Iterator first, Iterator last ){
+        
+        for( auto it = first; it != last; ++it ){
+            (*it)->mIsAlive = false;
+        }
+        
+        needsRefresh = true;
+        refresh();
+    }
+    
+    // destroys all entities for which `predicate( entity )` returns true, followed by a single compaction
+    template<typename Predicate>
+    std::size_t destroyWhere( Predicate predicate ){
+        
+        std::size_t count = 0;
+        for( auto& e : mEntities ){
+            if( e->isAlive() && predicate( e ) ){
+                e->mIsAlive = false;
+                ++count;
+            }
+        }
+        
+        if( count > 0 ){
+            needsRefresh = true;
+            refresh();
+        }
+        
+        return count;
+    }
+    
+    void reserveComponents( ComponentID id, std::size_t count ){
+        mComponents[id].reserve( mComponents[id].size() + count );
+        mComponentsByType[id].reserve( mComponentsByType[id].size() + count );
+    }
+
     template<typename T, typename... TArgs>
     std::shared_ptr<T> createSystem(TArgs&&... _Args) {
 
@@ -67,6 +175,12 @@ public:
 
         SystemRef systemPtr{ rawSystem };
         rawSystem->mManager = this;
+        if( rawSystem->mName.empty() ){
+            rawSystem->mName = typeid(T).name();
+        }
+        if( !rawSystem->mHasRandomSeed ){
+            rawSystem->mRandomSeed = mSystems.size();
+        }
         
         mSystems.push_back( rawSystem );
         return  rawSystem;
@@ -97,30 +211,204 @@ public:
 
 
     void update(){
-
-        if( needsRefresh == true ){
-            refresh();
+        
+        // sync point: the previous background step has to be done before anything reads the live state
+        if( mPipelined ){
+            waitForSimulation();
         }
-
-
-        for(auto& sys  : mSystems){
+        
+        ECS_PROFILE_EXPR( mProfiler.beginFrame( mEntities.size() ) );
+        
+        if( mPipelined ){
             
-            if( sys->updatable ){
-                sys->update();
+            // snapshot the finished step and start the next one in the background
+            runDeferred();
+            extractRenderPacket();
+            updateDrawSystem();
+            
+            mSimulation = mPipelineThread->submit( [this]{ simulate(); } );
+            return;
+        }
+        
+        runDeferred();
+        simulate();
+        extractRenderPacket();
+        updateDrawSystem();
+    }
+    
+    // pipelining ------
+    
+    // when on, update() runs the systems on a worker thread while the main thread draws the previous frame's render packet.
+    // The two sides share nothing: the components, the queries, the frame arena and getFrameTime() belong to the simulation,
+    // draw() and the drawables read getRenderPacket() only ( its frameTime included ), and changes from the main thread go
+    // through defer(). Call it from the thread that calls update(), the live accessors assert if that thread uses them while
+    // a step is in flight
+    void setPipelined( bool pipelined ){
+        
+        if( pipelined == mPipelined ){
+            return;
+        }
+        
+        waitForSimulation();
+        if( pipelined && !mPipelineThread ){
+            mPipelineThread.reset( new ThreadPool( 1 ) );
+        }
+        mOwnerThread = std::this_thread::get_id();
+        mPipelined = pipelined;
+    }
+    
+    bool isPipelined() const { return mPipelined; }
+    
+    // true on the thread that calls update() while a background step runs, the live state is off limits until the next update()
+    bool isSimulationInFlight() const {
+        return mPipelined && std::this_thread::get_id() == mOwnerThread && mSimulation.valid();
+    }
+    
+    // workers shared by the systems that split their update ( see ThreadPool::parallelFor ), one less than
+    // the cores since the calling thread works too, created on first use
+    ThreadPool& getWorkerPool(){
+        
+        if( !mWorkerPool ){
+            auto cores = std::thread::hardware_concurrency();
+            mWorkerPool.reset( new ThreadPool( cores > 1 ? cores - 1 : 1 ) );
+        }
+        return *mWorkerPool;
+    }
+    
+    // blocks until the background simulation step, if any, is over, rethrows what it threw
+    void waitForSimulation(){
+        
+        if( mSimulation.valid() ){
+            mSimulation.get();
+        }
+    }
+    
+    // runs `command` on the main thread at the next sync point, when no simulation step is running
+    void defer( std::function<void( Manager& )> command ){
+        
+        std::lock_guard<std::mutex> lock( mDeferredMutex );
+        mDeferred.push_back( std::move( command ) );
+    }
+    
+    // what the systems extracted after the last finished simulation step
+    const RenderPacket& getRenderPacket() const { return mRenderPacket; }
+    
+    std::uint64_t getTick() const { return mTick; }
+    
+    // fixed timestep ------
+    
+    // systems update in steps of `stepSeconds`, as many times per frame as the elapsed time asks for, up to `maxStepsPerFrame`
+    void setFixedTimestep( double stepSeconds, std::uint32_t maxStepsPerFrame = 5 ){
+        
+        assert( stepSeconds > 0.0 && maxStepsPerFrame > 0 );
+        
+        mFixedStepSeconds = stepSeconds;
+        mMaxStepsPerFrame = maxStepsPerFrame;
+        mStepAccumulator = 0.0;
+    }
+    
+    // back to one update per frame
+    void disableFixedTimestep(){ mFixedStepSeconds = 0.0; }
+    
+    bool isFixedTimestep() const { return mFixedStepSeconds > 0.0; }
+    double getFixedTimestep() const { return mFixedStepSeconds; }
+    
+    // resources ------
+    
+    // creates ( or replaces ) the manager's single instance of T
+    template<typename T, typename... Args>
+    T* setResource( Args&&... args ){
+        
+        auto id = getResourceTypeID<T>();
+        if( mResources.size() <= id ){
+            mResources.resize( id + 1 );
+        }
+        
+        auto resource = std::make_shared<T>( std::forward<Args>(args)... );
+        mResources[id] = resource;
+        return resource.get();
+    }
+    
+    // O(1) typed access, nullptr if the resource was never set
+    template<typename T>
+    T* getResource() const {
+        
+        auto id = getResourceTypeID<T>();
+        return id < mResources.size() ? static_cast<T*>( mResources[id].get() ) : nullptr;
+    }
+    
+    template<typename T>
+    bool hasResource() const { return getResource<T>() != nullptr; }
+    
+    template<typename T>
+    void removeResource(){
+        
+        auto id = getResourceTypeID<T>();
+        if( id < mResources.size() ){
+            mResources[id].reset();
+        }
+    }
+    
+    // timing of the simulation, the draw side reads getRenderPacket().frameTime instead
+    FrameTime* getFrameTime() const {
+        assertLiveAccess();
+        return getResource<FrameTime>();
+    }
+    
+    // O(1) check of whether any component of type T changed after `tick`
+    template<typename T>
+    bool hasChangedSince( std::uint64_t tick ) const {
+        return mTypeChangedTicks[ getComponentTypeID<T>() ].load( std::memory_order_relaxed ) > tick;
+    }
+    
+    // components of type T that called markChanged ( or were added ) after `tick`, usually a system's getLastRunTick()
+    template<typename T>
+    std::vector<T*> getChangedComponents( std::uint64_t tick ){
+        
+        std::vector<T*> changed;
+        
+        if( !hasChangedSince<T>( tick ) ){
+            return changed;
+        }
+        
+        for( auto c : getComponentsArray<T>() ){
+            if( c->hasChangedSince( tick ) ){
+                changed.push_back( c );
             }
         }
         
-        mDrawSystem->update();
+        return changed;
+    }
+    
+    // same as getChangedComponents, restricted to the components of active entities
+    template<typename T>
+    std::vector<T*> getActiveChangedComponents( std::uint64_t tick ){
+        
+        std::vector<T*> changed;
+        
+        if( !hasChangedSince<T>( tick ) ){
+            return changed;
+        }
+        
+        for( auto c : getActiveComponentsSpan<T>() ){
+            if( c->hasChangedSince( tick ) ){
+                changed.push_back( c );
+            }
+        }
+        
+        return changed;
     }
 
     void draw(){
 
         for(auto& sys  : mSystems){
             if( sys->drawable ){
+                ECS_PROFILE_SCOPE( mProfiler, sys->getName().c_str(), "draw" );
                 sys->draw();
             }
         }
         
+        ECS_PROFILE_SCOPE( mProfiler, "DrawSystem", "draw" );
         mDrawSystem->draw();
     }
 
@@ -130,49 +418,231 @@ public:
         if( !needsRefresh ){
             return;
         }
-
+        
+        ECS_PROFILE_EXPR( double refreshStart = mProfiler.now() );
+        ECS_PROFILE_SCOPE( mProfiler, "refresh", "refresh" );
     
         for( std::size_t i = 0; i < mComponents.size(); ++i ){
 
 
             auto& componentVector(mComponents[i]);
+            
+            if( componentVector.empty() ){
+                continue;
+            }
 
-            // erase components
-            for( auto cIt = componentVector.begin(); cIt != componentVector.end(); ) {
+            // erase components, compacting the vector in a single pass
+            auto isDead = []( const ComponentRef& c ) -> bool {
+                auto entity = c->getEntity().lock();
+                return !entity || !entity->isAlive();
+            };
+            
+            auto firstDead = std::stable_partition( componentVector.begin(), componentVector.end(), [&isDead]( const ComponentRef& c ){ return !isDead( c ); } );
+            for( auto cIt = firstDead; cIt != componentVector.end(); ++cIt ){
+                (*cIt)->onDestroy();
                 
-                if( (*cIt)->getEntity().expired() || !(*cIt)->getEntity().lock()->isAlive() ){
-                    (*cIt)->onDestroy();
-                    cIt = componentVector.erase(cIt);
+                // components removed with removeComponent were already reported, only destroyed entities are left
+                if( mObservedTypes[i] && !(*cIt)->getEntity().expired() ){
+                    notifyComponentRemoved( i, (*cIt)->getEntity() );
+                }
+            }
+            auto numDead = std::distance( firstDead, componentVector.end() );
+            if( numDead > 0 ){
+                if( mNumActive[i] == componentVector.size() ){
+                    mNumActive[i] -= numDead;
                 }else{
-                    ++cIt;
+                    mActivityDirty.set( i );
                 }
             }
+            mTypeCounters[i].frees += numDead;
+            mTypeCounters[i].totalFrees += numDead;
+            componentVector.erase( firstDead, componentVector.end() );
             
             
-            mComponentsByType[i].clear();
-            for(auto cp :  componentVector){
-                mComponentsByType[i].push_back( cp.get() );
+            auto& rawVector = mComponentsByType[i];
+            rawVector.clear();
+            for( auto& cp :  componentVector ){
+                rawVector.push_back( cp.get() );
             }
         }
         
-        for( auto eIt = mEntities.begin(); eIt != mEntities.end();  ){
-
-            if( ! (*eIt)->isAlive() || (*eIt == nullptr)  )
-            {
-                eIt = mEntities.erase( eIt );
+        mEntities.erase( std::remove_if( mEntities.begin(), mEntities.end(), [this]( const EntityRef& e ){
+            
+            if( e == nullptr ){
+                return true;
             }
             
-            else
-            {
-                ++eIt;
+            if( !e->isAlive() ){
+                ECS_PROFILE_EXPR( mProfiler.addStructuralChange() );
+                if( e->isRegistered() ){
+                    notifyTagsRemoved( e );
+                    mStorage.release( e->mIndex );
+                }
+                return true;
             }
-        }
+            
+            return false;
+        }), mEntities.end() );
+        
         needsRefresh = false;
+        
+        for( std::size_t i = 0; i < internal::getNumComponentTypes(); ++i ){
+            if( mActivityDirty[i] ){
+                partitionActive( i );
+            }
+        }
+        
+        ECS_PROFILE_EXPR( mProfiler.addRefreshTime( mProfiler.now() - refreshStart ) );
     }
 
     void addComponent( ComponentID id, const ComponentRef component){
         mComponents[id].push_back( component );
         mComponentsByType[id].push_back( component.get() );
+        
+        countAllocations( id, component.get(), 1 );
+        
+        // inactive components go to the back so they're already partitioned, an active one only is if there are no inactive ones yet
+        auto entity = component->getEntity().lock();
+        if( !entity || entity->isActive() ){
+            if( !mActivityDirty[id] && mNumActive[id] + 1 == mComponents[id].size() ){
+                mNumActive[id]++;
+            }else{
+                mActivityDirty.set( id );
+            }
+        }
+    }
+    
+    // memory and allocation report, allocation counts are for the last complete frame
+    ManagerStats getStats() const {
+        
+        ManagerStats stats;
+        
+        for( std::size_t i = 0; i < internal::getNumComponentTypes(); ++i ){
+            
+            const auto& counters = mTypeCounters[i];
+            if( counters.totalAllocations == 0 ){
+                continue; // tags and types never added to this manager
+            }
+            
+            ComponentTypeStats type;
+            type.id = i;
+            type.name = counters.name;
+            type.componentSize = counters.componentSize;
+            type.liveCount = mComponents[i].size();
+            type.capacity = mComponents[i].capacity();
+            
+            // every component is a shared_ptr'd object with its own factory helper, plus a shared and a raw pointer in the manager
+            std::size_t factoryBytes = type.liveCount * counters.factorySize;
+            type.bytes = type.liveCount * counters.componentSize + factoryBytes
+                       + mComponents[i].capacity() * sizeof( ComponentRef )
+                       + mComponentsByType[i].capacity() * sizeof( Component* );
+            
+            type.allocationsLastFrame = counters.lastAllocations;
+            type.freesLastFrame = counters.lastFrees;
+            type.totalAllocations = counters.totalAllocations;
+            type.totalFrees = counters.totalFrees;
+            type.fragmentation = type.capacity == 0 ? 0.0f : 1.0f - float( type.liveCount ) / float( type.capacity );
+            
+            stats.factoryBytes += factoryBytes;
+            stats.allocationsLastFrame += counters.lastAllocations;
+            stats.freesLastFrame += counters.lastFrees;
+            stats.components.push_back( type );
+        }
+        
+        stats.numEntities = mEntities.size();
+        stats.entityBytes = mEntities.size() * sizeof( Entity ) + mEntities.capacity() * sizeof( EntityRef );
+        stats.entityTableBytes = mStorage.getMemoryUsage();
+        stats.entityTableRecords = mStorage.size();
+        stats.entityTableFree = mStorage.getNumFree();
+        stats.entityTableFragmentation = mStorage.size() == 0 ? 0.0f : float( mStorage.getNumFree() ) / float( mStorage.size() );
+        
+        for( auto& r : mResources ){
+            stats.numResources += r ? 1 : 0;
+        }
+        stats.numObservers = mObservers.size();
+        
+        stats.arenaBytesUsed = mFrameArena.getBytesUsed();
+        stats.arenaCapacity = mFrameArena.getCapacity();
+        
+        return stats;
+    }
+    
+    // creates an observer that collects additions, removals and changes of T, the lists are published at the start of every update
+    template<typename T>
+    ObserverRef observe(){
+        
+        auto cId = getComponentTypeID<T>();
+        auto observer = std::make_shared<Observer>( cId );
+        observer->mLastFlushTick = mTick - 1;
+        
+        mObservers.push_back( observer );
+        mObservedTypes.set( cId );
+        
+        return observer;
+    }
+    
+    void removeObserver( const ObserverRef& iObserver ){
+        
+        mObservers.erase( std::remove( mObservers.begin(), mObservers.end(), iObserver ), mObservers.end() );
+        
+        mObservedTypes.reset();
+        for( auto& o : mObservers ){
+            mObservedTypes.set( o->getComponentId() );
+        }
+    }
+    
+    void notifyComponentAdded( ComponentID id, const EntityHandle& entity ){
+        
+        if( !mObservedTypes[id] ){
+            return;
+        }
+        
+        for( auto& o : mObservers ){
+            if( o->getComponentId() == id ){
+                o->notifyAdded( entity );
+            }
+        }
+    }
+    
+    void notifyComponentRemoved( ComponentID id, const EntityHandle& entity ){
+        
+        if( !mObservedTypes[id] ){
+            return;
+        }
+        
+        for( auto& o : mObservers ){
+            if( o->getComponentId() == id ){
+                o->notifyRemoved( entity );
+            }
+        }
+    }
+    
+    // tags have no component object to go through the refresh, report them when their entity is released
+    void notifyTagsRemoved( const EntityRef& e ){
+        
+        if( mObservedTypes.none() ){
+            return;
+        }
+        
+        const auto& signature = mStorage.getSignature( e->mIndex );
+        for( auto& o : mObservers ){
+            
+            auto cId = o->getComponentId();
+            if( signature[cId] && mStorage.getComponent( cId, e->mIndex ) == nullptr ){
+                o->notifyRemoved( e );
+            }
+        }
+    }
+    
+    // publishes what every observer collected since the previous flush, called by update()
+    void flushObservers(){
+        
+        for( auto& o : mObservers ){
+            
+            auto cId = o->getComponentId();
+            bool typeChanged = mTypeChangedTicks[cId].load( std::memory_order_relaxed ) > o->getLastFlushTick();
+            o->flush( mComponentsByType[cId], mTick, typeChanged );
+        }
     }
 
 
@@ -185,9 +655,10 @@ public:
 
         auto cId = getComponentTypeID<T>();
 
-        auto components = mComponents[cId];
+        const auto& components = mComponents[cId];
 
         std::vector<std::weak_ptr< T > > vec;
+        vec.reserve( components.size() );
         for( auto& c : components ){
             vec.push_back( std::weak_ptr<T>{ std::static_pointer_cast<T>(c) } );
         }
@@ -197,13 +668,13 @@ public:
 
 
     template<class T>
-    void setBitset(std::bitset<MaxComponents>* bitset, T head)const {
+    void setBitset(ComponentBitset* bitset, T head)const {
         bitset->set( head, 1 );
     }
 
 
     template <class T, class ...Args>
-    void  setBitset(std::bitset<MaxComponents>* bitset, T head ,  Args ... args) const {
+    void  setBitset(ComponentBitset* bitset, T head ,  Args ... args) const {
         setBitset( bitset, head );
         setBitset( bitset, args ... );
     }
@@ -211,6 +682,7 @@ public:
     template <class T>
     const std::vector<T*>& getComponentsArray() {
         
+        assertLiveAccess();
         if( needsRefresh ){
             refresh();
         }
@@ -223,12 +695,19 @@ public:
     template <class ...Args>
     std::vector<std::shared_ptr<Entity>> getEntitiesWithComponents() const {
         
-        std::bitset<MaxComponents> bitsetMask;
+        assertLiveAccess();
+        
+        ComponentBitset bitsetMask;
         setBitset( &bitsetMask, getComponentTypeID<Args>()... );
+        
+        // the match flags are local, so const queries can run concurrently
+        std::vector<std::uint8_t> matches( mStorage.size() );
+        matchQuery( bitsetMask, false, matches.data() );
+        
         std::vector<std::shared_ptr<Entity>> entities;
         for( auto &e : mEntities ){
             
-            bool b = ( e->getComponentBitset() | bitsetMask  ) == e->getComponentBitset(); // check if entity has all the bits in the bitset mask
+            bool b = matches[ e->mIndex ] != 0; // check if entity has all the bits in the bitset mask
             if( b ){
                  entities.push_back( e );
              }
@@ -238,25 +717,83 @@ public:
         return entities;
     };
     
+    // same as getEntitiesWithComponents but the result lives in the frame arena, valid until the next update()
+    template <class ...Args>
+    Span<Entity*> getEntitiesWithComponentsSpan() {
+        
+        ComponentBitset bitsetMask;
+        setBitset( &bitsetMask, getComponentTypeID<Args>()... );
+        
+        return collectQueryMatches( bitsetMask, false );
+    }
+    
+    // view over the raw component pointers of type T, no copy
+    template <class T>
+    Span<T*> getComponentsSpan() {
+        
+        auto& components = getComponentsArray<T>();
+        return Span<T*>( (T**)components.data(), components.size() );
+    }
+    
+    // components of type T whose entity is active, the component arrays keep them in front of the inactive ones
+    template <class T>
+    Span<T*> getActiveComponentsSpan() {
+        
+        auto& components = getComponentsArray<T>();
+        
+        auto cId = getComponentTypeID<T>();
+        if( mActivityDirty[cId] ){
+            partitionActive( cId );
+        }
+        
+        return Span<T*>( (T**)components.data(), mNumActive[cId] );
+    }
+    
+    // entities with all the components that are active, valid until the next update()
+    template <class ...Args>
+    Span<Entity*> getActiveEntitiesWithComponentsSpan() {
+        
+        ComponentBitset bitsetMask;
+        setBitset( &bitsetMask, getComponentTypeID<Args>()... );
+        
+        return collectQueryMatches( bitsetMask, true );
+    }
+    
+    // flags the component arrays of these types for a repartition, the next refresh or active query sorts them
+    void markActivityChanged( const ComponentBitset& types ){ mActivityDirty = mActivityDirty | types; }
+    void markActivityChanged( ComponentID id ){ mActivityDirty.set( id ); }
+    
+    FrameArena& getFrameArena() {
+        assertLiveAccess();
+        return mFrameArena;
+    }
+    
+#if ECS_ENABLE_PROFILING
+    // per frame system timings, export them with getProfiler().exportChromeTrace( path )
+    Profiler& getProfiler() { return mProfiler; }
+#endif
+    
     EntityRef copyEntity( const EntityRef& iEntity ){
         
         EntityRef e;
         
         iEntity->mInfo->copy( iEntity, e );
+        registerEntity( e.get() );
         
         mEntities.push_back(e);
         
-        for(size_t i = 0; i < e->mComponentBitset.size(); ++i){
+        const auto signature = iEntity->getComponentBitset();
+        for(size_t i = 0; i < signature.size(); ++i){
             
-            if(  e->mComponentBitset[i] == true ){
+            if(  signature[i] == true ){
                 
-                ComponentRef targetComponent;
-                auto sourceComponent = e->mComponentArray[i];
+                auto sourceComponent = iEntity->mStorage->getComponent( i, iEntity->mIndex );
+                ComponentRef targetComponent = sourceComponent->getFactory()->create();
 
                 sourceComponent->getFactory()->copyComponent( sourceComponent, targetComponent.get() );
                 targetComponent->mEntity = e;
-                mComponents[i].push_back(  targetComponent );
-                e->mComponentArray[i] = mComponents[i].back().get();
+                addComponent( i, targetComponent );
+                mStorage.setComponent( i, e->mIndex, targetComponent.get() );
             }
         }
         
@@ -264,7 +801,11 @@ public:
     }
     
     
-    std::vector<EntityRef>& getEntities() {  return mEntities; }
+    std::vector<EntityRef>& getEntities() {
+        assertLiveAccess();
+        return mEntities;
+    }
+    const EntityStorage& getStorage() const { return mStorage; }
     std::vector<SystemRef>& getSystems() { return mSystems; }
     
     DrawSystem* getDrawSystem(){
@@ -285,9 +826,366 @@ public:
 
     
 protected:
+    
+    // one frame of simulation: refresh, observers and the update() of every system for each step
+    void simulate(){
+
+        if( needsRefresh == true ){
+            refresh();
+        }
+        
+        // everything handed out from the arena last frame is released here
+        mFrameArena.reset();
+        
+        for( std::size_t i = 0; i < internal::getNumComponentTypes(); ++i ){
+            auto& counters = mTypeCounters[i];
+            counters.lastAllocations = counters.allocations;
+            counters.lastFrees = counters.frees;
+            counters.allocations = counters.frees = 0;
+        }
+        
+        updateFrameTime();
+        
+        flushObservers();
+        
+        for( auto& sys : mSystems ){
+            if( sys->updatable ){
+                sys->beginFrame();
+            }
+        }
+        
+        auto frameTime = getFrameTime();
+        for( std::uint32_t s = 0; s < frameTime->steps; ++s ){
+            
+            frameTime->step += 1;
+            
+            for(auto& sys  : mSystems){
+                
+                if( sys->updatable ){
+                    
+                    // systems with a lower update rate skip steps until their interval has passed, they always run once first
+                    sys->mTimeSinceUpdate += frameTime->stepSeconds;
+                    if( sys->mUpdateInterval > 0.0 ){
+                        
+                        sys->mRateAccumulator += frameTime->stepSeconds;
+                        if( sys->mLastRunTick == 0 ){
+                            sys->mRateAccumulator = 0.0;
+                        }else if( sys->mRateAccumulator < sys->mUpdateInterval ){
+                            continue;
+                        }else{
+                            // keep the remainder so the average rate holds, a system can't run more than once a step though
+                            sys->mRateAccumulator = std::fmod( sys->mRateAccumulator - sys->mUpdateInterval, sys->mUpdateInterval );
+                        }
+                    }
+                    sys->mDeltaSeconds = sys->mTimeSinceUpdate;
+                    sys->mTimeSinceUpdate = 0.0;
+                    
+                    // every system runs on its own tick so it can tell its own writes apart from everyone else's
+                    ++mTick;
+                    ECS_PROFILE_SCOPE( mProfiler, sys->getName().c_str(), "update" );
+                    sys->update();
+                    sys->mLastRunTick = mTick;
+                }
+            }
+        }
+        
+        // changes made outside of the systems ( events, draw ) get a fresh tick
+        ++mTick;
+    }
+    
+    void runDeferred(){
+        
+        std::vector< std::function<void( Manager& )> > commands;
+        {
+            std::lock_guard<std::mutex> lock( mDeferredMutex );
+            commands.swap( mDeferred );
+        }
+        
+        for( auto& c : commands ){
+            c( *this );
+        }
+    }
+    
+    void extractRenderPacket(){
+        
+        mRenderPacket.clear();
+        mRenderPacket.frameTime = *getFrameTime();
+        
+        for( auto& sys : mSystems ){
+            sys->extract( mRenderPacket );
+        }
+    }
+    
+    void updateDrawSystem(){
+        ECS_PROFILE_SCOPE( mProfiler, "DrawSystem", "update" );
+        mDrawSystem->update();
+    }
+    
+    void assertLiveAccess() const {
+        assert( !isSimulationInFlight() && "live manager state used by the draw side while a pipelined step runs, read getRenderPacket()" );
+    }
+    
+    bool mPipelined{ false };
+    std::thread::id mOwnerThread;
+    std::unique_ptr<ThreadPool> mPipelineThread;
+    std::unique_ptr<ThreadPool> mWorkerPool;
+    std::future<void> mSimulation;
+    
+    std::mutex mDeferredMutex;
+    std::vector< std::function<void( Manager& )> > mDeferred;
+    
+    RenderPacket mRenderPacket;
+    
+    
+    // gives the entity a fresh record in the storage
+    void registerEntity( Entity* e ){
+        registerEntity( e, mStorage.allocate() );
+    }
+    
+    void registerEntity( Entity* e, std::uint32_t index ){
+        e->mManager = this;
+        e->mStorage = &mStorage;
+        e->mIndex = index;
+        e->mGeneration = mStorage.getGeneration( e->mIndex );
+        ECS_PROFILE_EXPR( mProfiler.addStructuralChange() );
+    }
+    
+    // block space createEntities sets aside per entity for a component of type T and its factory, tags take none
+    template<typename T, typename std::enable_if< is_tag_component<T>::value, T>::type* = nullptr>
+    static constexpr std::size_t getBatchBytes(){ return 0; }
+    
+    template<typename T, typename std::enable_if< !is_tag_component<T>::value, T>::type* = nullptr>
+    static constexpr std::size_t getBatchBytes(){
+        using Stored = typename std::conditional< std::is_base_of<Component, T>::value, T, WrapperComponent<T> >::type;
+        return BatchAllocator<Stored>::getSharedBytes() + BatchAllocator< ComponentFactoryTemplate<Stored> >::getSharedBytes();
+    }
+    
+    // adds a default constructed T to every entity of a new batch, the batch version of Entity::addComponent
+    template<typename T, typename std::enable_if< !is_tag_component<T>::value, T>::type* = nullptr>
+    void addComponents( const std::vector<EntityRef>& entities, const std::shared_ptr<BatchBlock>& block ){
+        
+        using Stored = typename std::conditional< std::is_base_of<Component, T>::value, T, WrapperComponent<T> >::type;
+        
+        auto cId = getComponentTypeID<T>();
+        auto count = entities.size();
+        
+        auto& components = mComponents[cId];
+        auto& rawComponents = mComponentsByType[cId];
+        auto first = components.size();
+        components.reserve( first + count );
+        rawComponents.reserve( first + count );
+        mStorage.reserveLookup( cId );
+        
+        for( auto& e : entities ){
+            
+            auto component = std::allocate_shared<Stored>( BatchAllocator<Stored>( block ) );
+            auto helper = std::allocate_shared< ComponentFactoryTemplate<Stored> >( BatchAllocator< ComponentFactoryTemplate<Stored> >( block ) );
+            helper->owner = component.get();
+            component->mFactory = helper;
+            
+            component->mEntity = e;
+            component->mManager = this;
+            component->mComponentId = cId;
+            component->mChangedTick = mTick;
+            
+            mStorage.setComponent( cId, e->mIndex, component.get() );
+            rawComponents.push_back( component.get() );
+            components.push_back( std::move( component ) );
+        }
+        
+        countAllocations( cId, components.back().get(), count );
+        mTypeChangedTicks[cId].store( mTick, std::memory_order_relaxed );
+        
+        // new entities are active, the batch stays partitioned if the type was
+        if( !mActivityDirty[cId] && mNumActive[cId] == first ){
+            mNumActive[cId] += count;
+        }else{
+            mActivityDirty.set( cId );
+        }
+        
+        for( std::size_t i = first; i < first + count; ++i ){
+            components[i]->setup();
+        }
+        
+        if( mObservedTypes[cId] ){
+            for( auto& e : entities ){
+                notifyComponentAdded( cId, e );
+            }
+        }
+    }
+    
+    template<typename T, typename std::enable_if< is_tag_component<T>::value, T>::type* = nullptr>
+    void addComponents( const std::vector<EntityRef>& entities, const std::shared_ptr<BatchBlock>& ){
+        
+        auto cId = getComponentTypeID<T>();
+        for( auto& e : entities ){
+            mStorage.setTag( cId, e->mIndex, true );
+        }
+        
+        if( mObservedTypes[cId] ){
+            for( auto& e : entities ){
+                notifyComponentAdded( cId, e );
+            }
+        }
+    }
+    
+    // allocation counters of a type, named after the first component's factory
+    void countAllocations( ComponentID id, Component* component, std::size_t count ){
+        
+        auto& counters = mTypeCounters[id];
+        if( counters.componentSize == 0 && component->getFactory() ){
+            counters.name = component->getFactory()->getTypeName();
+            counters.componentSize = component->getFactory()->getComponentSize();
+            counters.factorySize = component->getFactory()->getFactorySize();
+        }
+        counters.allocations += count;
+        counters.totalAllocations += count;
+        ECS_PROFILE_EXPR( mProfiler.addStructuralChange( count ) );
+    }
 
     bool needsRefresh{false};
     
+    std::uint64_t mTick{ 1 };
+    std::array< std::atomic<std::uint64_t>, MaxComponents > mTypeChangedTicks;
+    
+    EntityStorage mStorage;
+    
+    std::vector<ObserverRef> mObservers;
+    ComponentBitset mObservedTypes;
+    
+    std::vector<std::shared_ptr<void>> mResources;
+    
+    void updateFrameTime(){
+        
+        auto frameTime = getResource<FrameTime>();
+        if( frameTime == nullptr ){
+            frameTime = setResource<FrameTime>();
+        }
+        
+        double elapsed = std::chrono::duration<double>( std::chrono::steady_clock::now() - mStartTime ).count();
+        
+        frameTime->deltaSeconds = frameTime->frame == 0 ? 0.0 : elapsed - frameTime->elapsedSeconds;
+        frameTime->elapsedSeconds = elapsed;
+        frameTime->frame += 1;
+        
+        if( !isFixedTimestep() ){
+            frameTime->stepSeconds = frameTime->deltaSeconds;
+            frameTime->steps = 1;
+            frameTime->alpha = 1.0;
+            return;
+        }
+        
+        frameTime->stepSeconds = mFixedStepSeconds;
+
+        // the first frame has no elapsed time yet, it still runs one step so the systems start from a simulated state
+        if( frameTime->frame == 1 ){
+            mStepAccumulator = 0.0;
+            frameTime->steps = 1;
+            frameTime->alpha = 1.0;
+            return;
+        }
+
+        mStepAccumulator += frameTime->deltaSeconds;
+
+        auto steps = static_cast<std::uint32_t>( mStepAccumulator / mFixedStepSeconds );
+        if( steps > mMaxStepsPerFrame ){
+            // too far behind, drop the backlog instead of spiraling
+            steps = mMaxStepsPerFrame;
+            mStepAccumulator = steps * mFixedStepSeconds;
+        }
+        mStepAccumulator -= steps * mFixedStepSeconds;
+        
+        frameTime->steps = steps;
+        frameTime->alpha = mStepAccumulator / mFixedStepSeconds;
+    }
+    
+    std::chrono::steady_clock::time_point mStartTime;
+    
+    double mFixedStepSeconds{ 0.0 };
+    std::uint32_t mMaxStepsPerFrame{ 5 };
+    double mStepAccumulator{ 0.0 };
+    
+    // match the mask against the packed signatures, `matches` has one flag per record index
+    void matchQuery( const ComponentBitset& mask, bool activeOnly, std::uint8_t* matches ) const {
+        
+        const auto& signatures = mStorage.getSignatures();
+        if( !signatures.empty() ){
+            matchSignatures( signatures.data(), signatures.size(), mask, matches );
+        }
+        
+        if( activeOnly ){
+            for( std::uint32_t i = 0; i < signatures.size(); ++i ){
+                matches[i] &= mStorage.isActive( i ) ? 1 : 0;
+            }
+        }
+    }
+    
+    // the entities matching `mask`, in creation order. The flags and the result both come from the frame arena,
+    // so like every arena allocation this is for the thread running the frame only
+    Span<Entity*> collectQueryMatches( const ComponentBitset& mask, bool activeOnly ){
+        
+        assertLiveAccess();
+
+        std::uint8_t* matches = mFrameArena.allocate<std::uint8_t>( mStorage.size() );
+        matchQuery( mask, activeOnly, matches );
+        
+        std::size_t count = 0;
+        for( auto &e : mEntities ){
+            count += matches[ e->mIndex ];
+        }
+        
+        Entity** entities = mFrameArena.allocate<Entity*>( count );
+        std::size_t i = 0;
+        for( auto &e : mEntities ){
+            if( matches[ e->mIndex ] ){
+                entities[i++] = e.get();
+            }
+        }
+        
+        return Span<Entity*>( entities, count );
+    }
+    
+    // moves the components of active entities in front of the inactive ones
+    void partitionActive( ComponentID id ){
+        
+        auto& components = mComponents[id];
+        auto firstInactive = std::stable_partition( components.begin(), components.end(), []( const ComponentRef& c ){
+            auto entity = c->getEntity().lock();
+            return entity && entity->isActive();
+        });
+        mNumActive[id] = std::distance( components.begin(), firstInactive );
+        
+        auto& rawVector = mComponentsByType[id];
+        rawVector.clear();
+        for( auto& cp : components ){
+            rawVector.push_back( cp.get() );
+        }
+        
+        mActivityDirty.reset( id );
+    }
+    
+    // per type, the first mNumActive components belong to active entities unless the type is flagged in mActivityDirty
+    std::array<std::size_t, MaxComponents> mNumActive{};
+    ComponentBitset mActivityDirty;
+    
+    // per frame scratch memory, reset at the start of every update()
+    FrameArena mFrameArena;
+    
+#if ECS_ENABLE_PROFILING
+    Profiler mProfiler;
+#endif
+    
+    struct TypeCounters {
+        const char* name{ "" };
+        std::size_t componentSize{ 0 };
+        std::size_t factorySize{ 0 };
+        
+        std::size_t allocations{ 0 }, frees{ 0 };           // current frame
+        std::size_t lastAllocations{ 0 }, lastFrees{ 0 };   // last complete frame
+        std::size_t totalAllocations{ 0 }, totalFrees{ 0 };
+    };
+    std::array<TypeCounters, MaxComponents> mTypeCounters;
+    
     std::array< std::vector<ComponentRef>, MaxComponents> mComponents;
     //we use this to cast a whole vector at once, only possible with a raw pointer
     // TODO: make this the main array, not a copy, by using `new` and `delete`
@@ -300,6 +1198,7 @@ protected:
     DrawSystem* mDrawSystem;
     
     friend class Entity;
+    friend struct Component;
 };
 
 
@@ -0,0 +1,89 @@
+//
+//  Observer.h
+//
+//  Collects the entities whose component of a given type was added, removed
+//  or changed during a frame. The Manager publishes the collected lists at the
+//  start of every update(), systems read them as packed vectors instead of
+//  reacting to each event.
+//
+
+#ifndef LEKSAPP_OBSERVER_H
+#define LEKSAPP_OBSERVER_H
+
+#include <vector>
+#include <cstdint>
+
+#include "Component.h"
+
+namespace ecs{
+
+    class Observer {
+
+    public:
+
+        Observer( ComponentID iComponentId ) : mComponentId( iComponentId ) { }
+
+        // entities that received the component during the previous frame
+        const std::vector<EntityHandle>& getAdded() const { return mAdded; }
+
+        // entities that lost the component ( or were destroyed ) during the previous frame
+        const std::vector<EntityHandle>& getRemoved() const { return mRemoved; }
+
+        // entities whose component called markChanged during the previous frame, newly added components are included
+        const std::vector<EntityHandle>& getChanged() const { return mChanged; }
+
+        bool empty() const { return mAdded.empty() && mRemoved.empty() && mChanged.empty(); }
+
+        ComponentID getComponentId() const { return mComponentId; }
+
+        void setEnabled( bool enabled ){ mEnabled = enabled; }
+        bool isEnabled() const { return mEnabled; }
+
+    protected:
+
+        void notifyAdded( const EntityHandle& entity ){
+            if( mEnabled ) mPendingAdded.push_back( entity );
+        }
+
+        void notifyRemoved( const EntityHandle& entity ){
+            if( mEnabled ) mPendingRemoved.push_back( entity );
+        }
+
+        // publishes the pending lists and gathers the components changed after the previous flush
+        void flush( const std::vector<Component*>& components, std::uint64_t currentTick, bool typeChanged ){
+
+            mAdded.swap( mPendingAdded );
+            mRemoved.swap( mPendingRemoved );
+            mPendingAdded.clear();
+            mPendingRemoved.clear();
+
+            mChanged.clear();
+            if( mEnabled && typeChanged ){
+                for( auto c : components ){
+                    if( c->hasChangedSince( mLastFlushTick ) ){
+                        mChanged.push_back( c->getEntity() );
+                    }
+                }
+            }
+
+            mLastFlushTick = currentTick;
+        }
+
+        std::uint64_t getLastFlushTick() const { return mLastFlushTick; }
+
+        ComponentID mComponentId;
+        bool mEnabled{ true };
+        std::uint64_t mLastFlushTick{ 0 };
+
+        std::vector<EntityHandle> mAdded, mPendingAdded;
+        std::vector<EntityHandle> mRemoved, mPendingRemoved;
+        std::vector<EntityHandle> mChanged;
+
+        friend class Manager;
+    };
+
+    using ObserverRef = std::shared_ptr<Observer>;
+
+}
+
+#endif //LEKSAPP_OBSERVER_H
@@ -0,0 +1,259 @@
+//
+//  Profiler.h
+//
+//  Per-frame instrumentation of the Manager: system update / draw times,
+//  refresh time, entity counts and structural changes. Frames can be
+//  exported as Chrome trace-event JSON ( chrome://tracing, Perfetto ).
+//
+//  Events can be recorded from any thread.
+//
+//  Define ECS_ENABLE_PROFILING=1 to turn it on, otherwise the ECS_PROFILE_*
+//  macros expand to nothing and the Manager carries no profiler at all.
+//
+
+#ifndef LEKSAPP_PROFILER_H
+#define LEKSAPP_PROFILER_H
+
+#ifndef ECS_ENABLE_PROFILING
+    #define ECS_ENABLE_PROFILING 0
+#endif
+
+#if ECS_ENABLE_PROFILING
+
+#include <chrono>
+#include <deque>
+#include <vector>
+#include <string>
+#include <ostream>
+#include <fstream>
+#include <cstdint>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+#include <algorithm>
+
+#if defined( __GNUG__ )
+    #include <cxxabi.h>
+#endif
+
+namespace ecs{
+
+    class Profiler {
+
+    public:
+
+        struct Event {
+            std::string name;
+            const char* category;
+            double startMicros;
+            double durationMicros;
+            std::size_t thread;
+        };
+
+        struct Frame {
+            std::uint64_t index{ 0 };
+            double startMicros{ 0.0 };
+            double durationMicros{ 0.0 };
+            double refreshMicros{ 0.0 };
+            std::size_t numEntities{ 0 };
+            std::size_t structuralChanges{ 0 };
+            std::vector<Event> events;
+        };
+
+        Profiler() : mOrigin( Clock::now() ) { }
+
+        void setEnabled( bool enabled ){ mEnabled = enabled; }
+        bool isEnabled() const { return mEnabled; }
+
+        // how many frames are kept for export
+        void setMaxFrames( std::size_t maxFrames ){ mMaxFrames = maxFrames; }
+
+        double now() const {
+            return std::chrono::duration<double, std::micro>( Clock::now() - mOrigin ).count();
+        }
+
+        // closes the running frame and opens a new one
+        void beginFrame( std::size_t numEntities ){
+
+            if( !mEnabled ){
+                return;
+            }
+
+            std::lock_guard<std::mutex> lock( mMutex );
+
+            double t = now();
+            if( mHasFrame ){
+                mCurrent.durationMicros = t - mCurrent.startMicros;
+                mFrames.push_back( std::move( mCurrent ) );
+                while( mFrames.size() > mMaxFrames ){
+                    mFrames.pop_front();
+                }
+            }
+
+            mCurrent = Frame();
+            mCurrent.index = mFrameCount++;
+            mCurrent.startMicros = t;
+            mCurrent.numEntities = numEntities;
+            mHasFrame = true;
+        }
+
+        void record( const char* name, const char* category, double startMicros, double durationMicros ){
+
+            if( !mEnabled || !mHasFrame ){
+                return;
+            }
+
+            std::lock_guard<std::mutex> lock( mMutex );
+
+            Event e;
+            e.name = name;
+            e.category = category;
+            e.startMicros = startMicros;
+            e.durationMicros = durationMicros;
+            e.thread = getThreadIndex();
+            mCurrent.events.push_back( e );
+        }
+
+        void addRefreshTime( double micros ){
+            std::lock_guard<std::mutex> lock( mMutex );
+            mCurrent.refreshMicros += micros;
+        }
+
+        void addStructuralChange( std::size_t count = 1 ){
+            std::lock_guard<std::mutex> lock( mMutex );
+            mCurrent.structuralChanges += count;
+        }
+
+        // frames that finished, oldest first
+        const std::deque<Frame>& getFrames() const { return mFrames; }
+        const Frame* getLastFrame() const { return mFrames.empty() ? nullptr : &mFrames.back(); }
+
+        void clear(){ mFrames.clear(); }
+
+        void exportChromeTrace( std::ostream& os ) const {
+
+            std::lock_guard<std::mutex> lock( mMutex );
+
+            os << "{\"traceEvents\":[";
+
+            bool first = true;
+            auto separator = [&]{ if( !first ) os << ","; first = false; };
+
+            for( auto& f : mFrames ){
+
+                separator();
+                os << "{\"name\":\"frame " << f.index << "\",\"cat\":\"frame\",\"ph\":\"X\",\"pid\":0,\"tid\":0"
+                   << ",\"ts\":" << f.startMicros << ",\"dur\":" << f.durationMicros
+                   << ",\"args\":{\"refresh_us\":" << f.refreshMicros << "}}";
+
+                for( auto& e : f.events ){
+                    separator();
+                    os << "{\"name\":\"" << escape( demangle( e.name ) ) << "\",\"cat\":\"" << e.category << "\",\"ph\":\"X\",\"pid\":0,\"tid\":" << e.thread
+                       << ",\"ts\":" << e.startMicros << ",\"dur\":" << e.durationMicros << "}";
+                }
+
+                separator();
+                os << "{\"name\":\"entities\",\"ph\":\"C\",\"pid\":0,\"ts\":" << f.startMicros
+                   << ",\"args\":{\"count\":" << f.numEntities << ",\"structural_changes\":" << f.structuralChanges << "}}";
+            }
+
+            os << "]}";
+        }
+
+        bool exportChromeTrace( const std::string& path ) const {
+
+            std::ofstream file( path );
+            if( !file ){
+                return false;
+            }
+            exportChromeTrace( file );
+            return true;
+        }
+
+    private:
+
+        using Clock = std::chrono::steady_clock;
+
+        // small stable index per thread, the trace viewer shows one row per index
+        std::size_t getThreadIndex(){
+
+            auto id = std::this_thread::get_id();
+            auto it = std::find( mThreads.begin(), mThreads.end(), id );
+            if( it != mThreads.end() ){
+                return std::distance( mThreads.begin(), it );
+            }
+            mThreads.push_back( id );
+            return mThreads.size() - 1;
+        }
+
+        static std::string demangle( const std::string& name ){
+#if defined( __GNUG__ )
+            int status = 0;
+            char* readable = abi::__cxa_demangle( name.c_str(), nullptr, nullptr, &status );
+            if( status == 0 && readable ){
+                std::string result( readable );
+                std::free( readable );
+                return result;
+            }
+#endif
+            return name;
+        }
+
+        static std::string escape( const std::string& s ){
+            std::string out;
+            for( char c : s ){
+                if( c == '"' || c == '\\' ) out += '\\';
+                out += c;
+            }
+            return out;
+        }
+
+        Clock::time_point mOrigin;
+        bool mEnabled{ true };
+
+        std::size_t mMaxFrames{ 600 };
+        std::uint64_t mFrameCount{ 0 };
+
+        bool mHasFrame{ false };
+        Frame mCurrent;
+        std::deque<Frame> mFrames;
+
+        std::vector<std::thread::id> mThreads;
+        mutable std::mutex mMutex;
+    };
+
+
+    // records the lifetime of the scope as one trace event
+    class ProfileScope {
+
+    public:
+        ProfileScope( Profiler& iProfiler, const char* iName, const char* iCategory )
+        : mProfiler( iProfiler ), mName( iName ), mCategory( iCategory ), mStart( iProfiler.now() ) { }
+
+        ~ProfileScope(){
+            mProfiler.record( mName, mCategory, mStart, mProfiler.now() - mStart );
+        }
+
+    private:
+        Profiler& mProfiler;
+        const char* mName;
+        const char* mCategory;
+        double mStart;
+    };
+
+}
+
+#define ECS_PROFILE_CONCAT_IMPL( a, b ) a##b
+#define ECS_PROFILE_CONCAT( a, b ) ECS_PROFILE_CONCAT_IMPL( a, b )
+
+#define ECS_PROFILE_SCOPE( profiler, name, category ) ::ecs::ProfileScope ECS_PROFILE_CONCAT( _ecsProfileScope, __LINE__ )( profiler, name, category )
+#define ECS_PROFILE_EXPR( expr ) expr
+
+#else
+
+#define ECS_PROFILE_SCOPE( profiler, name, category )
+#define ECS_PROFILE_EXPR( expr )
+
+#endif
+
+#endif //LEKSAPP_PROFILER_H
@@ -0,0 +1,105 @@
+//
+//  Random.h
+//
+//  Small deterministic random number generator ( PCG32 ) for the systems.
+//  Unlike ci::Rand there is no shared state: every stream is a plain value,
+//  derived from a seed and a couple of keys, so parallel work can draw from
+//  its own stream without locks. Keying the streams by work item instead of
+//  by thread keeps the results the same whatever the number of threads.
+//
+
+#ifndef LEKSAPP_RANDOM_H
+#define LEKSAPP_RANDOM_H
+
+#include <cstdint>
+
+namespace ecs{
+
+    namespace internal{
+
+        // SplitMix64 finalizer, spreads nearby keys ( 0, 1, 2... ) over the whole range
+        inline std::uint64_t mixSeed( std::uint64_t z ) noexcept {
+            z += 0x9e3779b97f4a7c15ull;
+            z = ( z ^ ( z >> 30 ) ) * 0xbf58476d1ce4e5b9ull;
+            z = ( z ^ ( z >> 27 ) ) * 0x94d049bb133111ebull;
+            return z ^ ( z >> 31 );
+        }
+    }
+
+    class RandomStream {
+
+    public:
+
+        using result_type = std::uint32_t;
+
+        explicit RandomStream( std::uint64_t seed = 0, std::uint64_t stream = 0 ){
+            mInc = ( stream << 1u ) | 1u;
+            next();
+            mState += seed;
+            next();
+        }
+
+        // the stream for `seed` and the keys, ex: a system seed, the simulation step and a chunk index
+        static RandomStream derive( std::uint64_t seed, std::uint64_t key0, std::uint64_t key1 = 0 ){
+            auto h = internal::mixSeed( internal::mixSeed( internal::mixSeed( seed ) ^ key0 ) ^ key1 );
+            return RandomStream( h, internal::mixSeed( h ) );
+        }
+
+        // usable with the std distributions, but those differ between standard libraries, prefer the ones below for reproducible runs
+        static constexpr result_type min(){ return 0; }
+        static constexpr result_type max(){ return 0xffffffffu; }
+        result_type operator()(){ return next(); }
+
+        std::uint32_t next(){
+
+            std::uint64_t old = mState;
+            mState = old * 6364136223846793005ull + mInc;
+
+            auto shifted = static_cast<std::uint32_t>( ( ( old >> 18u ) ^ old ) >> 27u );
+            auto rot = static_cast<std::uint32_t>( old >> 59u );
+            return ( shifted >> rot ) | ( shifted << ( ( 0u - rot ) & 31u ) );
+        }
+
+        // 0 to bound - 1, without the modulo bias
+        std::uint32_t nextUint( std::uint32_t bound ){
+
+            if( bound == 0 ){
+                return 0;
+            }
+
+            std::uint32_t threshold = ( 0u - bound ) % bound;
+            for(;;){
+                auto r = next();
+                if( r >= threshold ){
+                    return r % bound;
+                }
+            }
+        }
+
+        // low to high - 1, like ci::Rand::randInt
+        std::int32_t nextInt( std::int32_t low, std::int32_t high ){
+            return high > low ? low + static_cast<std::int32_t>( nextUint( static_cast<std::uint32_t>( high - low ) ) ) : low;
+        }
+
+        // 0 to 1, 1 excluded
+        float nextFloat(){
+            return ( next() >> 8 ) * ( 1.0f / 16777216.0f );
+        }
+
+        float nextFloat( float low, float high ){
+            return low + ( high - low ) * nextFloat();
+        }
+
+        bool nextBool(){
+            return ( next() >> 31 ) != 0;
+        }
+
+    private:
+
+        std::uint64_t mState{ 0 };
+        std::uint64_t mInc{ 1 };
+    };
+
+}
+
+#endif //LEKSAPP_RANDOM_H
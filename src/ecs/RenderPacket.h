@@ -0,0 +1,98 @@
+//
+//  RenderPacket.h
+//
+//  Snapshot of everything the draw pass needs from a simulation frame. Systems
+//  fill it in System::extract() right after the update, the draw pass reads
+//  it instead of the components, so the next simulation step can already run
+//  while the packet is drawn ( see Manager::setPipelined ).
+//
+//  The packet is a set of typed channels, one vector per type, cleared but
+//  not freed between frames.
+//
+
+#ifndef LEKSAPP_RENDER_PACKET_H
+#define LEKSAPP_RENDER_PACKET_H
+
+#include <vector>
+#include <memory>
+#include <cstddef>
+
+#include "Resource.h"
+
+namespace ecs{
+
+    namespace internal{
+
+        inline std::size_t getUniqueChannelID() noexcept {
+            static std::size_t lastID{0};
+            return lastID++;
+        }
+
+        template <typename T>
+        inline std::size_t getChannelTypeID() noexcept {
+            static std::size_t typeID { getUniqueChannelID() };
+            return typeID;
+        }
+    }
+
+    class RenderPacket {
+
+    public:
+
+        // the channel of T, created on first use
+        template<typename T>
+        std::vector<T>& get(){
+
+            auto id = internal::getChannelTypeID<T>();
+            if( mChannels.size() <= id ){
+                mChannels.resize( id + 1 );
+            }
+
+            if( !mChannels[id] ){
+                mChannels[id].reset( new Channel<T>() );
+            }
+
+            return static_cast<Channel<T>*>( mChannels[id].get() )->items;
+        }
+
+        // the channel of T, nullptr if nothing was ever written to it
+        template<typename T>
+        const std::vector<T>* find() const {
+
+            auto id = internal::getChannelTypeID<T>();
+            if( id >= mChannels.size() || !mChannels[id] ){
+                return nullptr;
+            }
+
+            return &static_cast<const Channel<T>*>( mChannels[id].get() )->items;
+        }
+
+        // empties every channel, keeping their memory for the next frame
+        void clear(){
+            for( auto& c : mChannels ){
+                if( c ) c->clear();
+            }
+        }
+
+        // timing of the frame the packet was extracted from
+        FrameTime frameTime;
+
+    private:
+
+        struct ChannelBase {
+            virtual ~ChannelBase(){ }
+            virtual void clear() = 0;
+        };
+
+        template<typename T>
+        struct Channel : ChannelBase {
+            void clear() override { items.clear(); }
+            std::vector<T> items;
+        };
+
+        std::vector< std::unique_ptr<ChannelBase> > mChannels;
+    };
+
+}
+
+#endif //LEKSAPP_RENDER_PACKET_H
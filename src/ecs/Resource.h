@@ -0,0 +1,57 @@
+//
+//  Resource.h
+//
+//  Resources are global values ( frame timing, input state, settings... )
+//  stored once per Manager and fetched by type in O(1).
+//
+
+#ifndef LEKSAPP_RESOURCE_H
+#define LEKSAPP_RESOURCE_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace ecs{
+
+    using ResourceID = std::size_t;
+
+    namespace internal{
+
+        inline ResourceID getUniqueResourceID() noexcept {
+            static ResourceID lastID{0};
+            return lastID++;
+        }
+
+        template <typename T>
+        inline ResourceID getResourceTypeID() noexcept {
+            static ResourceID typeID { getUniqueResourceID() };
+            return typeID;
+        }
+    }
+
+    template <typename T>
+    inline ResourceID getResourceTypeID(){
+        return internal::getResourceTypeID<T>();
+    }
+
+
+    // timing of the current Manager::update(), always available as a resource
+    struct FrameTime {
+        double elapsedSeconds{ 0.0 };
+        double deltaSeconds{ 0.0 };
+        std::uint64_t frame{ 0 };
+        
+        // simulation time advanced by each system update, the fixed step size or deltaSeconds when the timestep is variable
+        double stepSeconds{ 0.0 };
+        
+        // simulation steps run this frame and in total
+        std::uint32_t steps{ 0 };
+        std::uint64_t step{ 0 };
+        
+        // how far the render time is between the last two steps, 0 to 1, used to interpolate what gets drawn
+        double alpha{ 1.0 };
+    };
+
+}
+
+#endif //LEKSAPP_RESOURCE_H
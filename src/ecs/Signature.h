@@ -0,0 +1,173 @@
+//
+//  Signature.h
+//
+//  Fixed width component mask stored as 64 bit words, plus the kernel used
+//  to match a mask against a packed array of signatures.
+//
+
+#ifndef LEKSAPP_SIGNATURE_H
+#define LEKSAPP_SIGNATURE_H
+
+#include <cstdint>
+#include <cstddef>
+
+#if defined( __AVX2__ )
+    #include <immintrin.h>
+    #define ECS_SIGNATURE_AVX2 1
+#elif defined( __SSE2__ ) || defined( _M_X64 ) || ( defined( _M_IX86_FP ) && _M_IX86_FP >= 2 )
+    #include <emmintrin.h>
+    #define ECS_SIGNATURE_SSE2 1
+#endif
+
+namespace ecs{
+
+    template<std::size_t Bits>
+    class Signature {
+
+        static_assert( Bits > 0 && Bits % 64 == 0, "signature width must be a multiple of 64" );
+
+    public:
+
+        static constexpr std::size_t NumWords = Bits / 64;
+
+        Signature(){ reset(); }
+
+        bool operator[]( std::size_t i ) const { return test( i ); }
+
+        bool test( std::size_t i ) const {
+            return ( mWords[ i / 64 ] >> ( i % 64 ) ) & 1u;
+        }
+
+        Signature& set( std::size_t i, bool value = true ){
+
+            const std::uint64_t bit = std::uint64_t( 1 ) << ( i % 64 );
+            if( value ){
+                mWords[ i / 64 ] |= bit;
+            }else{
+                mWords[ i / 64 ] &= ~bit;
+            }
+            return *this;
+        }
+
+        Signature& reset(){
+            for( std::size_t w = 0; w < NumWords; ++w ){
+                mWords[w] = 0;
+            }
+            return *this;
+        }
+
+        Signature& reset( std::size_t i ){ return set( i, false ); }
+
+        bool any() const {
+            for( std::size_t w = 0; w < NumWords; ++w ){
+                if( mWords[w] != 0 ) return true;
+            }
+            return false;
+        }
+
+        bool none() const { return !any(); }
+
+        std::size_t count() const {
+            std::size_t c = 0;
+            for( std::size_t w = 0; w < NumWords; ++w ){
+                for( std::uint64_t word = mWords[w]; word != 0; word &= word - 1 ){
+                    ++c;
+                }
+            }
+            return c;
+        }
+
+        // true if every bit set in `mask` is also set here
+        bool contains( const Signature& mask ) const {
+            for( std::size_t w = 0; w < NumWords; ++w ){
+                if( ( mWords[w] & mask.mWords[w] ) != mask.mWords[w] ) return false;
+            }
+            return true;
+        }
+
+        Signature operator&( const Signature& other ) const {
+            Signature result;
+            for( std::size_t w = 0; w < NumWords; ++w ){
+                result.mWords[w] = mWords[w] & other.mWords[w];
+            }
+            return result;
+        }
+
+        Signature operator|( const Signature& other ) const {
+            Signature result;
+            for( std::size_t w = 0; w < NumWords; ++w ){
+                result.mWords[w] = mWords[w] | other.mWords[w];
+            }
+            return result;
+        }
+
+        bool operator==( const Signature& other ) const {
+            for( std::size_t w = 0; w < NumWords; ++w ){
+                if( mWords[w] != other.mWords[w] ) return false;
+            }
+            return true;
+        }
+
+        bool operator!=( const Signature& other ) const { return !( *this == other ); }
+
+        constexpr std::size_t size() const { return Bits; }
+
+        const std::uint64_t* data() const { return mWords; }
+
+    private:
+        std::uint64_t mWords[NumWords];
+    };
+
+
+    // writes 1 into `out[i]` for every signature that contains all the bits in `mask`, 0 otherwise
+    template<std::size_t Bits>
+    void matchSignatures( const Signature<Bits>* signatures, std::size_t count, const Signature<Bits>& mask, std::uint8_t* out ){
+
+        const std::size_t numWords = Signature<Bits>::NumWords;
+
+#if defined( ECS_SIGNATURE_AVX2 )
+        if( numWords % 4 == 0 ){
+
+            for( std::size_t i = 0; i < count; ++i ){
+
+                const std::uint64_t* sig = signatures[i].data();
+                int matches = 1;
+                for( std::size_t w = 0; w < numWords; w += 4 ){
+                    __m256i m = _mm256_loadu_si256( reinterpret_cast<const __m256i*>( mask.data() + w ) );
+                    __m256i s = _mm256_loadu_si256( reinterpret_cast<const __m256i*>( sig + w ) );
+                    __m256i eq = _mm256_cmpeq_epi8( _mm256_and_si256( s, m ), m );
+                    matches &= ( _mm256_movemask_epi8( eq ) == -1 );
+                }
+                out[i] = static_cast<std::uint8_t>( matches );
+            }
+            return;
+        }
+#endif
+
+#if defined( ECS_SIGNATURE_AVX2 ) || defined( ECS_SIGNATURE_SSE2 )
+        if( numWords % 2 == 0 ){
+
+            for( std::size_t i = 0; i < count; ++i ){
+
+                const std::uint64_t* sig = signatures[i].data();
+                int matches = 1;
+                for( std::size_t w = 0; w < numWords; w += 2 ){
+                    __m128i m = _mm_loadu_si128( reinterpret_cast<const __m128i*>( mask.data() + w ) );
+                    __m128i s = _mm_loadu_si128( reinterpret_cast<const __m128i*>( sig + w ) );
+                    __m128i eq = _mm_cmpeq_epi8( _mm_and_si128( s, m ), m );
+                    matches &= ( _mm_movemask_epi8( eq ) == 0xFFFF );
+                }
+                out[i] = static_cast<std::uint8_t>( matches );
+            }
+            return;
+        }
+#endif
+
+        for( std::size_t i = 0; i < count; ++i ){
+            out[i] = signatures[i].contains( mask ) ? 1 : 0;
+        }
+    }
+
+}
+
+#endif //LEKSAPP_SIGNATURE_H
@@ -0,0 +1,47 @@
+//
+//  Span.h
+//
+//  Non owning view over a contiguous range, returned by the allocation free
+//  query variants. Only valid until the storage it points to changes, for
+//  arena backed spans that is the end of the frame.
+//
+
+#ifndef LEKSAPP_SPAN_H
+#define LEKSAPP_SPAN_H
+
+#include <cstddef>
+#include <cassert>
+
+namespace ecs{
+
+    template<typename T>
+    class Span {
+
+    public:
+
+        Span() = default;
+        Span( T* iData, std::size_t iSize ) : mData( iData ), mSize( iSize ) { }
+
+        T* begin() const { return mData; }
+        T* end() const { return mData + mSize; }
+
+        T* data() const { return mData; }
+        std::size_t size() const { return mSize; }
+        bool empty() const { return mSize == 0; }
+
+        T& operator[]( std::size_t i ) const {
+            assert( i < mSize );
+            return mData[i];
+        }
+
+        T& front() const { return (*this)[0]; }
+        T& back() const { return (*this)[ mSize - 1 ]; }
+
+    private:
+        T* mData{ nullptr };
+        std::size_t mSize{ 0 };
+    };
+
+}
+
+#endif //LEKSAPP_SPAN_H
@@ -0,0 +1,69 @@
+//
+//  Stats.h
+//
+//  Memory and allocation counters reported by Manager::getStats().
+//
+
+#ifndef LEKSAPP_STATS_H
+#define LEKSAPP_STATS_H
+
+#include <string>
+#include <vector>
+#include <cstddef>
+
+#include "Component.h"
+
+namespace ecs{
+
+    struct ComponentTypeStats {
+
+        ComponentID id{ 0 };
+        std::string name;
+
+        std::size_t componentSize{ 0 };     // sizeof the component type
+        std::size_t liveCount{ 0 };
+        std::size_t capacity{ 0 };          // slots reserved in the manager's component vectors
+        std::size_t bytes{ 0 };             // components + factory helpers + manager side pointers
+
+        std::size_t allocationsLastFrame{ 0 };
+        std::size_t freesLastFrame{ 0 };
+        std::size_t totalAllocations{ 0 };
+        std::size_t totalFrees{ 0 };
+
+        // share of reserved slots that are unused, 0 when the storage is tight
+        float fragmentation{ 0.0f };
+    };
+
+    struct ManagerStats {
+
+        std::vector<ComponentTypeStats> components;
+
+        std::size_t numEntities{ 0 };
+        std::size_t entityBytes{ 0 };           // entity objects, counted as ecs::Entity ( derived entities are bigger )
+        std::size_t entityTableBytes{ 0 };      // records, free list and component lookup tables
+        std::size_t entityTableRecords{ 0 };
+        std::size_t entityTableFree{ 0 };
+        float entityTableFragmentation{ 0.0f };
+
+        std::size_t factoryBytes{ 0 };
+        std::size_t numResources{ 0 };
+        std::size_t numObservers{ 0 };
+
+        std::size_t arenaBytesUsed{ 0 };
+        std::size_t arenaCapacity{ 0 };
+
+        std::size_t allocationsLastFrame{ 0 };
+        std::size_t freesLastFrame{ 0 };
+
+        std::size_t getTotalBytes() const {
+            std::size_t total = entityBytes + entityTableBytes + arenaCapacity;
+            for( auto& c : components ){
+                total += c.bytes;
+            }
+            return total;
+        }
+    };
+
+}
+
+#endif //LEKSAPP_STATS_H
@@ -9,3 +9,9 @@
 //#include "UpdateDrawables.h"
 
 using namespace ecs;
+
+RandomStream System::getRandomStream( std::uint64_t key ) const {
+    
+    auto frameTime = mManager ? mManager->getFrameTime() : nullptr;
+    return RandomStream::derive( mRandomSeed, frameTime ? frameTime->step : 0, key );
+}
@@ -6,8 +6,16 @@
 #define LEKSAPP_SYSTEM_H
 
 #include <memory>
+#include <cstdint>
+#include <vector>
+#include <algorithm>
+#include <string>
+#include <chrono>
 
 #include "Component.h"
+#include "Resource.h"
+#include "RenderPacket.h"
+#include "Random.h"
 
 
 namespace ecs{
@@ -20,8 +28,14 @@ namespace ecs{
         virtual void setup() {  }
 
         virtual void update(){  }
+        
+        // called once at the start of every simulated frame, before the steps, even when no step runs or the system is rate limited
+        virtual void beginFrame() {  }
 
         virtual void draw() {   }
+        
+        // copy what draw() needs into the packet, called after every update() of the manager while no simulation is running
+        virtual void extract( RenderPacket& packet ) {   }
        
         void setUpdatable( bool v ){ updatable = v; }
         void setDrawable( bool v ){ drawable = v; }
@@ -31,12 +45,140 @@ namespace ecs{
 
         Manager* getManager() {  return mManager; }
         
+        // defaults to the type name given to Manager::createSystem, used by the profiler
+        const std::string& getName() const { return mName; }
+        void setName( const std::string& name ){ mName = name; }
+        
+        // manager tick of this system's previous update, components with a newer changed tick were modified since
+        std::uint64_t getLastRunTick() const { return mLastRunTick; }
+        
+        // run update() at most `hz` times per second of simulation time, 0 runs it every step
+        void setUpdateRate( double hz ){ mUpdateInterval = hz > 0.0 ? 1.0 / hz : 0.0; }
+        double getUpdateRate() const { return mUpdateInterval > 0.0 ? 1.0 / mUpdateInterval : 0.0; }
+        
+        // simulation time covered by the current update(), longer than a step for systems with a lower update rate
+        double getDeltaSeconds() const { return mDeltaSeconds; }
+        
+        // time slicing ------
+        
+        // wall clock time a single processSlice call may spend, 0 disables the budget
+        void setSliceBudget( double seconds ){ mSliceBudget = seconds; }
+        double getSliceBudget() const { return mSliceBudget; }
+        
+        // upper bound of items a single processSlice call visits, 0 disables the limit
+        void setSliceSize( std::size_t count ){ mSliceSize = count; }
+        
+        // calls fn on the items following the ones visited by the previous call, wrapping around,
+        // until the time budget or the slice size runs out. Returns the number of items visited.
+        template<typename T, typename Fn>
+        std::size_t processSlice( const std::vector<T>& items, Fn fn ){
+            
+            const std::size_t count = items.size();
+            if( count == 0 ){
+                return 0;
+            }
+            
+            if( mSliceCursor >= count ){
+                mSliceCursor = 0;
+            }
+            
+            const std::size_t limit = mSliceSize > 0 ? std::min( mSliceSize, count ) : count;
+            const auto start = std::chrono::steady_clock::now();
+            
+            std::size_t visited = 0;
+            while( visited < limit ){
+                
+                fn( items[mSliceCursor] );
+                ++visited;
+                
+                if( ++mSliceCursor == count ){
+                    mSliceCursor = 0;
+                    ++mSlicePasses;
+                }
+                
+                // reading the clock isn't free, check it every few items
+                if( mSliceBudget > 0.0 && ( visited % 16 ) == 0 ){
+                    if( std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count() >= mSliceBudget ){
+                        break;
+                    }
+                }
+            }
+            
+            return visited;
+        }
+        
+        // number of times processSlice went through every item
+        std::size_t getSlicePasses() const { return mSlicePasses; }
+        void resetSliceCursor(){ mSliceCursor = 0; }
+        
+        // random numbers ------
+        
+        // defaults to the order the system was created in, so every system gets different numbers
+        void setRandomSeed( std::uint64_t seed ){ mRandomSeed = seed; mHasRandomSeed = true; }
+        std::uint64_t getRandomSeed() const { return mRandomSeed; }
+        
+        // a stream keyed by the seed, the current simulation step and `key`. Parallel updates key it by chunk
+        // or item, not by thread slot, so they draw the same numbers whatever the number of threads
+        RandomStream getRandomStream( std::uint64_t key = 0 ) const;
+        
+        // declare which manager resources this system reads or writes, usually from the constructor or setup()
+        template<typename T>
+        void readsResource(){ addUnique( mResourceReads, getResourceTypeID<T>() ); }
+        
+        template<typename T>
+        void writesResource(){ addUnique( mResourceWrites, getResourceTypeID<T>() ); }
+        
+        const std::vector<ResourceID>& getResourceReads() const { return mResourceReads; }
+        const std::vector<ResourceID>& getResourceWrites() const { return mResourceWrites; }
+        
+        // true if this system and `other` can't run at the same time, one of them writes a resource the other one uses
+        bool conflictsWith( const System& other ) const {
+            
+            for( auto id : mResourceWrites ){
+                if( contains( other.mResourceWrites, id ) || contains( other.mResourceReads, id ) ) return true;
+            }
+            for( auto id : other.mResourceWrites ){
+                if( contains( mResourceReads, id ) ) return true;
+            }
+            return false;
+        }
+        
     protected:
         friend  Manager;
-        Manager* mManager;
+        Manager* mManager{ nullptr };
         
         bool updatable = true;
         bool drawable = true;
+        
+        std::uint64_t mLastRunTick{ 0 };
+        
+        double mUpdateInterval{ 0.0 };
+        double mTimeSinceUpdate{ 0.0 };
+        double mRateAccumulator{ 0.0 };
+        double mDeltaSeconds{ 0.0 };
+        
+        double mSliceBudget{ 0.0 };
+        std::size_t mSliceSize{ 0 };
+        std::size_t mSliceCursor{ 0 };
+        std::size_t mSlicePasses{ 0 };
+        
+        std::string mName;
+        
+        std::uint64_t mRandomSeed{ 0 };
+        bool mHasRandomSeed{ false };
+        
+        std::vector<ResourceID> mResourceReads;
+        std::vector<ResourceID> mResourceWrites;
+        
+    private:
+        
+        static bool contains( const std::vector<ResourceID>& ids, ResourceID id ){
+            return std::find( ids.begin(), ids.end(), id ) != ids.end();
+        }
+        
+        static void addUnique( std::vector<ResourceID>& ids, ResourceID id ){
+            if( !contains( ids, id ) ) ids.push_back( id );
+        }
 
     };
 
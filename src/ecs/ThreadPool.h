@@ -0,0 +1,151 @@
+//
+//  ThreadPool.h
+//
+//  Fixed set of worker threads fed from a single task queue. The Manager
+//  uses it to run the simulation in the background when pipelining is on,
+//  and systems use parallelFor() to split their update across cores.
+//
+
+#ifndef LEKSAPP_THREAD_POOL_H
+#define LEKSAPP_THREAD_POOL_H
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <atomic>
+#include <exception>
+#include <algorithm>
+
+namespace ecs{
+
+    class ThreadPool {
+
+    public:
+
+        explicit ThreadPool( std::size_t numThreads = std::thread::hardware_concurrency() ){
+
+            if( numThreads == 0 ){
+                numThreads = 1;
+            }
+
+            for( std::size_t i = 0; i < numThreads; ++i ){
+                mWorkers.emplace_back( [this]{ workerLoop(); } );
+            }
+        }
+
+        ThreadPool( const ThreadPool& ) = delete;
+        ThreadPool& operator=( const ThreadPool& ) = delete;
+
+        // finishes the queued tasks before joining
+        ~ThreadPool(){
+
+            {
+                std::lock_guard<std::mutex> lock( mMutex );
+                mStopping = true;
+            }
+            mCondition.notify_all();
+
+            for( auto& w : mWorkers ){
+                w.join();
+            }
+        }
+
+        // queues `task`, the future rethrows whatever the task threw
+        std::future<void> submit( std::function<void()> task ){
+
+            auto packaged = std::make_shared< std::packaged_task<void()> >( std::move( task ) );
+            auto future = packaged->get_future();
+
+            {
+                std::lock_guard<std::mutex> lock( mMutex );
+                mTasks.push_back( [packaged]{ (*packaged)(); } );
+            }
+            mCondition.notify_one();
+
+            return future;
+        }
+
+        // runs fn( index, slot ) for every index below `count`. The calling thread works as slot 0 and up to
+        // getNumThreads() helpers as slots 1 and up. Items are handed out one by one from a shared cursor, so
+        // whoever is free takes the next one and uneven items balance out. Blocks until every item ran and
+        // rethrows the first exception. Don't call it from one of this pool's own tasks
+        void parallelFor( std::size_t count, const std::function<void( std::size_t index, std::size_t slot )>& fn ){
+
+            std::atomic<std::size_t> cursor{ 0 };
+
+            auto run = [&cursor, &fn, count]( std::size_t slot ){
+                for( auto i = cursor.fetch_add( 1 ); i < count; i = cursor.fetch_add( 1 ) ){
+                    fn( i, slot );
+                }
+            };
+
+            auto numHelpers = std::min( count > 0 ? count - 1 : 0, mWorkers.size() );
+
+            std::vector< std::future<void> > helpers;
+            helpers.reserve( numHelpers );
+            for( std::size_t i = 0; i < numHelpers; ++i ){
+                helpers.push_back( submit( [&run, i]{ run( i + 1 ); } ) );
+            }
+
+            // the helpers reference this frame, wait for all of them even if something threw
+            std::exception_ptr error;
+            try{
+                run( 0 );
+            }catch( ... ){
+                error = std::current_exception();
+            }
+
+            for( auto& h : helpers ){
+                try{
+                    h.get();
+                }catch( ... ){
+                    if( !error ) error = std::current_exception();
+                }
+            }
+
+            if( error ){
+                std::rethrow_exception( error );
+            }
+        }
+
+        std::size_t getNumThreads() const { return mWorkers.size(); }
+
+    private:
+
+        void workerLoop(){
+
+            for(;;){
+
+                std::function<void()> task;
+                {
+                    std::unique_lock<std::mutex> lock( mMutex );
+                    mCondition.wait( lock, [this]{ return mStopping || !mTasks.empty(); } );
+
+                    if( mTasks.empty() ){
+                        return; // stopping and drained
+                    }
+
+                    task = std::move( mTasks.front() );
+                    mTasks.pop_front();
+                }
+
+                task();
+            }
+        }
+
+        std::vector<std::thread> mWorkers;
+        std::deque< std::function<void()> > mTasks;
+
+        std::mutex mMutex;
+        std::condition_variable mCondition;
+        bool mStopping{ false };
+    };
+
+}
+
+#endif //LEKSAPP_THREAD_POOL_H